@@ -0,0 +1,57 @@
+/**
+ * Runs a state machine on Linux without busy polling, the loop sleeps until
+ * the machine needs to be handled again.
+ * Build from the tests directory as the example_linux_sleep target.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <statemachine.hpp>
+
+extern "C" uint32_t millis() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+int main() {
+    uint8_t blinks = 0;
+    StateTimed offState{500};
+    StateTimed onState{100};
+    StateIdle doneState;
+
+    offState.setRunnable([&onState]() {
+        printf("%u on\n", millis());
+        return &onState;
+    });
+    onState.setRunnable([&offState, &doneState, &blinks]() -> State* {
+        printf("%u off\n", millis());
+
+        if (++blinks < 5) {
+            return &offState;
+        }
+
+        return &doneState;
+    });
+
+    StateMachine machine {&offState};
+    machine.start();
+    StateTime deadline;
+
+    // Stops when the machine is idle, a real application would wait for input here
+    while (machine.nextDeadline(deadline)) {
+        const int32_t wait = deadline - millis();
+
+        if (wait > 0) {
+            // Split in seconds, wait * 1000 microseconds overflows after about 35 minutes
+            const struct timespec duration = {wait / 1000, (wait % 1000) * 1000000L};
+            nanosleep(&duration, nullptr);
+        }
+
+        machine.handle();
+    }
+
+    printf("%u done\n", millis());
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "eventqueue.hpp"
+
+const size_t EventQueue::CACHE_LINE;
+
+static size_t roundUpToPowerOfTwo(const size_t p_value) {
+    size_t value = 2;
+
+    while (value < p_value) {
+        value <<= 1;
+    }
+
+    return value;
+}
+
+EventQueue::EventQueue(const size_t p_capacity) :
+    m_cells(new Cell[roundUpToPowerOfTwo(p_capacity)]),
+    m_mask(roundUpToPowerOfTwo(p_capacity) - 1),
+    m_enqueuePosition(0),
+    m_dequeuePosition(0) {
+    for (size_t i = 0; i <= m_mask; i++) {
+        m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+size_t EventQueue::capacity() const {
+    return m_mask + 1;
+}
+
+bool EventQueue::push(const EventId p_event) {
+    size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+    Cell* cell;
+
+    for (;;) {
+        cell = &m_cells[position & m_mask];
+        const size_t sequence = cell->m_sequence.load(std::memory_order_acquire);
+        const intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+        if (difference == 0) {
+            // Cell is free, claim it
+            if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // Cell still holds an event from the previous round
+            return false;
+        } else {
+            position = m_enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->m_event = p_event;
+    cell->m_sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool EventQueue::pop(EventId& p_event) {
+    Cell& cell = m_cells[m_dequeuePosition & m_mask];
+    const size_t sequence = cell.m_sequence.load(std::memory_order_acquire);
+
+    if ((intptr_t)sequence - (intptr_t)(m_dequeuePosition + 1) < 0) {
+        return false;
+    }
+
+    p_event = cell.m_event;
+    cell.m_sequence.store(m_dequeuePosition + m_mask + 1, std::memory_order_release);
+    m_dequeuePosition++;
+    return true;
+}
+
+size_t EventQueue::size() const {
+    return m_enqueuePosition.load(std::memory_order_relaxed) - m_dequeuePosition;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+#include "statemachine.hpp"
+
+/**
+ * Bounded lock free queue of events, any thread may push events and one thread pops them.
+ * Attach it to a StateMachine with setEventQueue() and the machine dispatches the queued events
+ * on each handle(), so states are only touched by the thread that calls handle().
+ * The buffer is allocated once when the queue is created.
+ */
+class EventQueue {
+private:
+    struct Cell {
+        std::atomic<size_t> m_sequence;
+        EventId m_event;
+    };
+
+    // Keep producers and the consumer on different cache lines
+    static const size_t CACHE_LINE = 64;
+
+    std::unique_ptr<Cell[]> m_cells;
+    const size_t m_mask;
+    alignas(CACHE_LINE) std::atomic<size_t> m_enqueuePosition;
+    alignas(CACHE_LINE) size_t m_dequeuePosition;
+
+public:
+    // p_capacity is rounded up to a power of two
+    EventQueue(const size_t p_capacity);
+
+    EventQueue(const EventQueue&) = delete;
+    EventQueue& operator=(const EventQueue&) = delete;
+
+    size_t capacity() const;
+
+    // Can be called from any thread, returns false when the queue is full
+    bool push(const EventId p_event);
+
+    // Only call from the thread that consumes the events, returns false when the queue is empty
+    bool pop(EventId& p_event);
+
+    // Only call from the thread that consumes the events, events still being pushed are counted too
+    size_t size() const;
+};
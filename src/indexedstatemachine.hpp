@@ -0,0 +1,148 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+#include <type_traits>
+#include "inplacefunction.hpp"
+#include "statemachineclock.hpp"
+#include "statetiming.hpp"
+
+#ifndef UNIT_TEST
+#include <Arduino.h>
+#else
+extern "C" uint32_t millis();
+#endif
+
+/**
+ * StateMachine with room for N states stored inside the machine itself.
+ * States are referred to by their id, the order in which they were added, which is a uint8_t for up to
+ * 254 states and a uint16_t above that, the largest value means no state. Runnables return the id of the
+ * next state instead of a State*, so handling a machine does not follow pointers to states spread over the heap.
+ * The first state added is the initial state.
+ *
+ * IndexedStateMachine<2> blink;
+ * const auto on = blink.addTimed(500);
+ * const auto off = blink.addTimed(500);
+ * blink.setRunnable(on, [off]() { return off; });
+ * blink.setRunnable(off, [on]() { return on; });
+ * blink.start();
+ */
+template<size_t N>
+class IndexedStateMachine {
+    static_assert(N > 0, "IndexedStateMachine needs at least one state");
+    static_assert(N < 0xFFFF, "IndexedStateMachine supports up to 65534 states");
+
+public:
+    typedef typename std::conditional < (N < 0xFF), uint8_t, uint16_t >::type TStateId;
+    typedef InplaceFunction<TStateId()> TRunFunction;
+
+    // Returned by add() when the machine is full
+    static const TStateId NONE = static_cast<TStateId>(~0);
+
+private:
+    struct Entry {
+        TRunFunction m_run;
+        StateTiming m_timing;
+    };
+
+    Entry m_states[N];
+    TStateId m_size;
+    TStateId m_currentState;
+    StateTime m_startTime;
+
+    TStateId add(const StateTiming::Kind p_kind, const StateTime p_forTime, const TRunFunction& p_run) {
+        if (m_size == N) {
+            return NONE;
+        }
+
+        m_states[m_size].m_run = p_run;
+        m_states[m_size].m_timing = StateTiming{p_forTime, p_kind};
+        return m_size++;
+    }
+
+public:
+    IndexedStateMachine() :
+        m_size(0),
+        m_currentState(0),
+        m_startTime(0) {
+    }
+
+    // Adds a state that runs its runnable on every handle(), like State
+    TStateId add(const TRunFunction& p_run = nullptr) {
+        return add(StateTiming::KIND_STATE, 0, p_run);
+    }
+
+    // Adds a state that runs its runnable once p_forTime has passed, like StateTimed
+    TStateId addTimed(const StateTime p_forTime, const TRunFunction& p_run = nullptr) {
+        return add(StateTiming::KIND_TIMED, p_forTime, p_run);
+    }
+
+    // Adds a state that only changes by something outside the machine, like StateIdle
+    TStateId addIdle(const TRunFunction& p_run = nullptr) {
+        return add(StateTiming::KIND_IDLE, 0, p_run);
+    }
+
+    // Sets the runnable of an added state, use it when states refer to each other
+    void setRunnable(const TStateId p_state, const TRunFunction& p_run) {
+        m_states[p_state].m_run = p_run;
+    }
+
+    // Number of added states
+    size_t size() const {
+        return m_size;
+    }
+
+    // Call start once after you created the state machine but as aclose as possible
+    // to your loop function
+    void start() {
+        start(MillisClock::now());
+    }
+
+    void start(const StateTime p_currentTime) {
+        m_currentState = 0;
+        m_startTime = p_currentTime;
+    }
+
+    // Evaluates if the current state is the given state
+    bool current(const TStateId p_id) const {
+        return m_currentState == p_id;
+    }
+
+    TStateId current() const {
+        return m_currentState;
+    }
+
+    // Call in your loop function regularly
+    void handle() {
+        handle(MillisClock::now());
+    }
+
+    void handle(const StateTime p_currentTime) {
+        const Entry& state = m_states[m_currentState];
+
+        if (!state.m_timing.due(m_startTime, p_currentTime) || !state.m_run) {
+            return;
+        }
+
+        const TStateId next = state.m_run();
+        assert(next < m_size);
+
+        if (next != m_currentState) {
+            m_currentState = next;
+            m_startTime = p_currentTime;
+        }
+    }
+
+    // Same as StateMachine::nextDeadline()
+    bool nextDeadline(StateTime& p_deadline) const {
+        return nextDeadline(MillisClock::now(), p_deadline);
+    }
+
+    bool nextDeadline(const StateTime p_currentTime, StateTime& p_deadline) const {
+        const Entry& state = m_states[m_currentState];
+        return state.m_timing.deadline(m_startTime, p_currentTime, static_cast<bool>(state.m_run), p_deadline);
+    }
+};
+
+template<size_t N>
+const typename IndexedStateMachine<N>::TStateId IndexedStateMachine<N>::NONE;
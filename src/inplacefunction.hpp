@@ -0,0 +1,114 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Number of bytes a lambda may capture when it is stored in a State.
+ * Define before including the library to change it, for example -DSTATEMACHINE_CAPTURE_SIZE=64
+ */
+#ifndef STATEMACHINE_CAPTURE_SIZE
+#define STATEMACHINE_CAPTURE_SIZE (4 * sizeof(void*))
+#endif
+
+template<typename Signature, size_t Capacity = STATEMACHINE_CAPTURE_SIZE>
+class InplaceFunction;
+
+/**
+ * Callable wrapper like std::function that stores the callable inside itself.
+ * It never allocates, callables that do not fit in Capacity fail to compile.
+ */
+template<typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+    typedef R (*TInvoke)(void* p_storage, Args&& ... p_args);
+    typedef void (*TManage)(void* p_dest, const void* p_source);
+
+    alignas(std::max_align_t) unsigned char m_storage[Capacity];
+    TInvoke m_invoke;
+    // Copies p_source into p_dest, or destroys p_dest when p_source is nullptr
+    TManage m_manage;
+
+    template<typename F>
+    static R invoke(void* p_storage, Args&& ... p_args) {
+        return (*static_cast<F*>(p_storage))(std::forward<Args>(p_args)...);
+    }
+
+    template<typename F>
+    static void manage(void* p_dest, const void* p_source) {
+        if (p_source == nullptr) {
+            static_cast<F*>(p_dest)->~F();
+        } else {
+            new (p_dest) F(*static_cast<const F*>(p_source));
+        }
+    }
+
+    void copyFrom(const InplaceFunction& p_other) {
+        m_invoke = p_other.m_invoke;
+        m_manage = p_other.m_manage;
+
+        if (m_manage != nullptr) {
+            m_manage(m_storage, p_other.m_storage);
+        }
+    }
+
+public:
+    InplaceFunction() :
+        m_invoke(nullptr),
+        m_manage(nullptr) {
+    }
+
+    InplaceFunction(std::nullptr_t) : InplaceFunction() {
+    }
+
+    template < typename F, typename = typename std::enable_if <
+                   !std::is_same<typename std::decay<F>::type, InplaceFunction>::value >::type >
+    InplaceFunction(F&& p_function) : InplaceFunction() {
+        typedef typename std::decay<F>::type TFunction;
+        static_assert(sizeof(TFunction) <= Capacity,
+                      "Callable captures too much to fit in a State, capture less or increase STATEMACHINE_CAPTURE_SIZE");
+        static_assert(alignof(TFunction) <= alignof(std::max_align_t), "Callable is over aligned");
+        new (m_storage) TFunction(std::forward<F>(p_function));
+        m_invoke = &invoke<TFunction>;
+        m_manage = &manage<TFunction>;
+    }
+
+    InplaceFunction(const InplaceFunction& p_other) : InplaceFunction() {
+        copyFrom(p_other);
+    }
+
+    ~InplaceFunction() {
+        reset();
+    }
+
+    InplaceFunction& operator=(const InplaceFunction& p_other) {
+        if (this != &p_other) {
+            reset();
+            copyFrom(p_other);
+        }
+
+        return *this;
+    }
+
+    InplaceFunction& operator=(std::nullptr_t) {
+        reset();
+        return *this;
+    }
+
+    void reset() {
+        if (m_manage != nullptr) {
+            m_manage(m_storage, nullptr);
+        }
+
+        m_invoke = nullptr;
+        m_manage = nullptr;
+    }
+
+    explicit operator bool() const {
+        return m_invoke != nullptr;
+    }
+
+    R operator()(Args... p_args) const {
+        return m_invoke(const_cast<unsigned char*>(m_storage), std::forward<Args>(p_args)...);
+    }
+};
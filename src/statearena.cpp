@@ -0,0 +1,67 @@
+#include "statearena.hpp"
+#include "statemachine.hpp"
+
+const size_t StateArena::ALIGN;
+
+StateArena::StateArena(const size_t p_capacity) :
+    m_memory(p_capacity == 0 ? nullptr : static_cast<unsigned char*>(::operator new(p_capacity))),
+    m_capacity(p_capacity),
+    m_used(0) {
+}
+
+StateArena::StateArena(StateArena&& p_other) :
+    m_memory(p_other.m_memory),
+    m_capacity(p_other.m_capacity),
+    m_used(p_other.m_used) {
+    p_other.m_memory = nullptr;
+    p_other.m_capacity = 0;
+    p_other.m_used = 0;
+}
+
+StateArena& StateArena::operator=(StateArena&& p_other) {
+    if (this != &p_other) {
+        destroy();
+        m_memory = p_other.m_memory;
+        m_capacity = p_other.m_capacity;
+        m_used = p_other.m_used;
+        p_other.m_memory = nullptr;
+        p_other.m_capacity = 0;
+        p_other.m_used = 0;
+    }
+
+    return *this;
+}
+
+StateArena::~StateArena() {
+    destroy();
+}
+
+void* StateArena::allocate(const size_t p_size) {
+    if (p_size > m_capacity - m_used) {
+        return nullptr;
+    }
+
+    return m_memory + m_used + sizeof(Header);
+}
+
+void StateArena::commit(State* p_state, const size_t p_size) {
+    Header* header = new (m_memory + m_used) Header;
+    header->m_state = p_state;
+    header->m_next = m_used + p_size;
+    m_used = header->m_next;
+}
+
+void StateArena::clear() {
+    for (size_t at = 0; at < m_used; at = reinterpret_cast<Header*>(m_memory + at)->m_next) {
+        reinterpret_cast<Header*>(m_memory + at)->m_state->~State();
+    }
+
+    m_used = 0;
+}
+
+void StateArena::destroy() {
+    clear();
+    ::operator delete(m_memory);
+    m_memory = nullptr;
+    m_capacity = 0;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <stddef.h>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+class State;
+
+/**
+ * One block of memory to build the states of a machine in, see DeletingStateMachine.
+ * States are placed in the order they are created, create states that transition into each other
+ * one after the other so they end up next to each other in memory.
+ * The block is allocated once and released in one step, destroying all states in it.
+ *
+ * StateArena arena{StateArena::sizeFor<State, StateTimed>()};
+ * auto first = arena.create<State>();
+ * auto second = arena.create<StateTimed>(10);
+ */
+class StateArena {
+    static const size_t ALIGN = alignof(std::max_align_t);
+
+    // Placed before every state so the states can be destroyed
+    struct alignas(std::max_align_t) Header {
+        State* m_state;
+        size_t m_next;
+    };
+
+    unsigned char* m_memory;
+    size_t m_capacity;
+    size_t m_used;
+
+    static constexpr size_t align(const size_t p_size) {
+        return (p_size + ALIGN - 1) & ~(ALIGN - 1);
+    }
+
+    // Returns memory for an object of p_size bytes or nullptr when the arena is full
+    void* allocate(const size_t p_size);
+    void commit(State* p_state, const size_t p_size);
+    void destroy();
+
+public:
+    // Bytes taken by a state of type T
+    template<typename T>
+    static constexpr size_t sizeOf() {
+        return sizeof(Header) + align(sizeof(T));
+    }
+
+    // Bytes needed to create one state of each of the given types
+    template<typename T>
+    static constexpr size_t sizeFor() {
+        return sizeOf<T>();
+    }
+
+    template<typename T, typename Next, typename... Rest>
+    static constexpr size_t sizeFor() {
+        return sizeOf<T>() + sizeFor<Next, Rest...>();
+    }
+
+    explicit StateArena(const size_t p_capacity = 0);
+    StateArena(StateArena&& p_other);
+    StateArena& operator=(StateArena&& p_other);
+    StateArena(const StateArena&) = delete;
+    StateArena& operator=(const StateArena&) = delete;
+    ~StateArena();
+
+    // Builds a T in the arena, returns nullptr when it does not fit
+    template<typename T, typename... Args>
+    T* create(Args&& ... p_args) {
+        static_assert(alignof(T) <= ALIGN, "State is over aligned");
+        void* memory = allocate(sizeOf<T>());
+
+        if (memory == nullptr) {
+            return nullptr;
+        }
+
+        T* state = new (memory) T(std::forward<Args>(p_args)...);
+        commit(state, sizeOf<T>());
+        return state;
+    }
+
+    // Destroys all states, the memory is kept for new states
+    void clear();
+
+    size_t capacity() const {
+        return m_capacity;
+    }
+
+    size_t used() const {
+        return m_used;
+    }
+};
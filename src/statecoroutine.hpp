@@ -0,0 +1,395 @@
+#pragma once
+#include "statemachine.hpp"
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+
+class StateCoroutine;
+
+/**
+ * Fixed number of equally sized blocks for coroutine frames, allocated once.
+ * Starting a coroutine when the pool is empty or the frame is bigger than a block fails, see failures().
+ * A pool is not thread safe, give each thread that handles machines with coroutine states its own pool.
+ */
+class StateCoroutinePool {
+    struct Block {
+        Block* m_next;
+    };
+
+    unsigned char* m_memory;
+    Block* m_free;
+    const size_t m_blockSize;
+    uint32_t m_failures;
+
+public:
+    StateCoroutinePool(const size_t p_blockSize, const size_t p_blocks) :
+        m_memory(static_cast<unsigned char*>(::operator new(((p_blockSize + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1)) * p_blocks))),
+        m_free(nullptr),
+        m_blockSize((p_blockSize + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1)),
+        m_failures(0) {
+        for (size_t i = p_blocks; i > 0; i--) {
+            Block* block = reinterpret_cast<Block*>(m_memory + (i - 1) * m_blockSize);
+            block->m_next = m_free;
+            m_free = block;
+        }
+    }
+
+    StateCoroutinePool(const StateCoroutinePool&) = delete;
+    StateCoroutinePool& operator=(const StateCoroutinePool&) = delete;
+
+    ~StateCoroutinePool() {
+        ::operator delete(m_memory);
+    }
+
+    void* allocate(const size_t p_size) {
+        if (p_size > m_blockSize || m_free == nullptr) {
+            m_failures++;
+            return nullptr;
+        }
+
+        Block* block = m_free;
+        m_free = block->m_next;
+        return block;
+    }
+
+    void release(void* p_frame) {
+        Block* block = static_cast<Block*>(p_frame);
+        block->m_next = m_free;
+        m_free = block;
+    }
+
+    // Number of coroutines that could not be started
+    uint32_t failures() const {
+        return m_failures;
+    }
+};
+
+/**
+ * Return type of the function of a StateCoroutine, co_return the State to go to
+ */
+class StateTask {
+public:
+    struct promise_type {
+        State* m_next = nullptr;
+        StateCoroutinePool* m_pool = nullptr;
+#if defined(__cpp_exceptions)
+        std::exception_ptr m_exception;
+#endif
+
+        // Set by StateCoroutine while it calls its function, the frame is taken from this pool
+        static StateCoroutinePool*& allocating() {
+            static thread_local StateCoroutinePool* pool = nullptr;
+            return pool;
+        }
+
+        // Room in front of the frame to remember its pool, frames are released while another pool may be allocating
+        static const size_t HEADER = alignof(std::max_align_t);
+
+        // Coroutine functions called outside of StateCoroutine have no pool and fail to start
+        static void* operator new(const size_t p_size) noexcept {
+            StateCoroutinePool* pool = allocating();
+
+            if (pool == nullptr) {
+                return nullptr;
+            }
+
+            void* block = pool->allocate(p_size + HEADER);
+
+            if (block == nullptr) {
+                return nullptr;
+            }
+
+            *static_cast<StateCoroutinePool**>(block) = pool;
+            return static_cast<unsigned char*>(block) + HEADER;
+        }
+
+        static void operator delete(void* p_frame) noexcept {
+            void* block = static_cast<unsigned char*>(p_frame) - HEADER;
+            (*static_cast<StateCoroutinePool**>(block))->release(block);
+        }
+
+        static StateTask get_return_object_on_allocation_failure() noexcept {
+            return StateTask{nullptr};
+        }
+
+        StateTask get_return_object() noexcept {
+            return StateTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+
+        void return_value(State* p_next) noexcept {
+            m_next = p_next;
+        }
+
+        // Rethrown from the handle() or dispatch() that resumed the coroutine
+        void unhandled_exception() noexcept {
+#if defined(__cpp_exceptions)
+            m_exception = std::current_exception();
+#else
+            std::terminate();
+#endif
+        }
+    };
+
+    explicit StateTask(std::coroutine_handle<promise_type> p_handle) :
+        m_handle(p_handle) {
+    }
+
+    StateTask(std::nullptr_t) :
+        m_handle(nullptr) {
+    }
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+/**
+ * State that runs a coroutine, so a flow with waits can be written as one function instead of a chain of states.
+ * The coroutine starts when the state is run the first time after it is entered and can co_await delay() and event().
+ * While waiting it is not run: nextDeadline() reports the end of a delay and a group parks it like a StateTimed,
+ * or sleeps it until the event is dispatched. co_return the state to go to, returning this state starts the coroutine again.
+ * Frames come from a StateCoroutinePool, resuming never allocates.
+ *
+ * StateCoroutine connect{pool, [&](StateCoroutine& self) -> StateTask {
+ *     while (!wifi.begin()) {
+ *         co_await self.delay(1000);
+ *     }
+ *     co_await self.event(DISCONNECTED);
+ *     co_return &self;
+ * }};
+ */
+class StateCoroutine : public State {
+public:
+    typedef InplaceFunction<StateTask(StateCoroutine&)> TCoroutineFunction;
+
+private:
+    enum Wait : uint8_t {
+        WAIT_START,
+        WAIT_NONE,
+        WAIT_DELAY,
+        WAIT_EVENT,
+        WAIT_EVENT_TIMEOUT
+    };
+
+    StateCoroutinePool& m_pool;
+    TCoroutineFunction m_function;
+    mutable std::coroutine_handle<StateTask::promise_type> m_handle;
+    mutable Wait m_wait;
+    mutable EventId m_event;
+    mutable bool m_eventArrived;
+    mutable StateTime m_waitStart;
+    mutable StateTime m_waitTime;
+    mutable StateTime m_currentTime;
+
+    struct DelayAwaiter {
+        const StateCoroutine& m_state;
+        StateTime m_time;
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<>) const noexcept {
+            m_state.m_wait = WAIT_DELAY;
+            m_state.m_waitStart = m_state.m_currentTime;
+            m_state.m_waitTime = m_time;
+        }
+
+        void await_resume() const noexcept {
+        }
+    };
+
+    struct EventAwaiter {
+        const StateCoroutine& m_state;
+        EventId m_event;
+        bool m_timeout;
+        StateTime m_time;
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<>) const noexcept {
+            m_state.m_wait = m_timeout ? WAIT_EVENT_TIMEOUT : WAIT_EVENT;
+            m_state.m_event = m_event;
+            m_state.m_eventArrived = false;
+            m_state.m_waitStart = m_state.m_currentTime;
+            m_state.m_waitTime = m_time;
+        }
+
+        // True when the event arrived, false on timeout
+        bool await_resume() const noexcept {
+            return m_state.m_eventArrived;
+        }
+    };
+
+    void destroy() const {
+        if (m_handle) {
+            m_handle.destroy();
+            m_handle = nullptr;
+        }
+    }
+
+    // Resumes the coroutine at p_currentTime, returns true when it finished. An exception in the coroutine
+    // ends it and is thrown here, the state starts over on the next run.
+    bool step(const StateTime p_currentTime) const {
+        m_currentTime = p_currentTime;
+        m_wait = WAIT_NONE;
+        m_handle.resume();
+
+#if defined(__cpp_exceptions)
+        if (m_handle.done() && m_handle.promise().m_exception) {
+            const std::exception_ptr exception = m_handle.promise().m_exception;
+            destroy();
+            m_wait = WAIT_START;
+            std::rethrow_exception(exception);
+        }
+#endif
+
+        return m_handle.done();
+    }
+
+    // Resumes the coroutine and returns the state to go to, a coroutine that returns this state starts again
+    // right away so it is waiting again, also when it was resumed by an event
+    State* resume(const StateTime p_currentTime) const {
+        if (!step(p_currentTime)) {
+            return (State*)this;
+        }
+
+        State* next = m_handle.promise().m_next;
+        destroy();
+        m_wait = WAIT_START;
+
+        if (next != nullptr && next != this) {
+            return next;
+        }
+
+        if (start() && step(p_currentTime)) {
+            next = m_handle.promise().m_next;
+            destroy();
+            m_wait = WAIT_START;
+            return next == nullptr ? (State*)this : next;
+        }
+
+        return (State*)this;
+    }
+
+    bool start() const {
+        StateCoroutinePool*& allocating = StateTask::promise_type::allocating();
+        StateCoroutinePool* previous = allocating;
+        allocating = &m_pool;
+        m_handle = m_function(const_cast<StateCoroutine&>(*this)).m_handle;
+        allocating = previous;
+        return static_cast<bool>(m_handle);
+    }
+
+    virtual void transitionStart(const StateTime p_currentTime) const {
+        destroy();
+        m_wait = WAIT_START;
+    }
+
+    virtual void transitionEnd(const StateTime p_currentTime) const {
+        destroy();
+    }
+
+    virtual bool deadline(const StateTime p_currentTime, StateTime& p_deadline) const {
+        switch (m_wait) {
+            case WAIT_DELAY:
+            case WAIT_EVENT_TIMEOUT:
+                p_deadline = m_waitStart + m_waitTime + 1;
+                return true;
+
+            case WAIT_EVENT:
+                return false;
+
+            default:
+                p_deadline = p_currentTime;
+                return true;
+        }
+    }
+
+    virtual State* react(const EventId p_event, const StateTime p_currentTime) const {
+        if ((m_wait != WAIT_EVENT && m_wait != WAIT_EVENT_TIMEOUT) || p_event != m_event) {
+            return (State*)this;
+        }
+
+        m_eventArrived = true;
+        return resume(p_currentTime);
+    }
+
+protected:
+    virtual State* run(const StateTime p_currentTime) const {
+        switch (m_wait) {
+            case WAIT_START:
+                if (!start()) {
+                    return (State*)this;
+                }
+
+                return resume(p_currentTime);
+
+            case WAIT_DELAY:
+            case WAIT_EVENT_TIMEOUT:
+                if (p_currentTime - m_waitStart <= m_waitTime) {
+                    return (State*)this;
+                }
+
+                return resume(p_currentTime);
+
+            case WAIT_EVENT:
+                return (State*)this;
+
+            default:
+                return resume(p_currentTime);
+        }
+    }
+
+public:
+    StateCoroutine(StateCoroutinePool& p_pool, const TCoroutineFunction& p_function) :
+        m_pool(p_pool),
+        m_function(p_function),
+        m_handle(nullptr),
+        m_wait(WAIT_START),
+        m_event(0),
+        m_eventArrived(false),
+        m_waitStart(0),
+        m_waitTime(0),
+        m_currentTime(0) {
+    }
+
+    StateCoroutine(const StateCoroutine&) = delete;
+    StateCoroutine& operator=(const StateCoroutine&) = delete;
+
+    virtual ~StateCoroutine() {
+        destroy();
+    }
+
+    // co_await to continue once p_time has passed
+    DelayAwaiter delay(const StateTime p_time) const {
+        return DelayAwaiter{*this, p_time};
+    }
+
+    // co_await to continue when p_event is dispatched
+    EventAwaiter event(const EventId p_event) const {
+        return EventAwaiter{*this, p_event, false, 0};
+    }
+
+    // co_await to continue when p_event is dispatched or p_timeout has passed, returns true when the event arrived
+    EventAwaiter event(const EventId p_event, const StateTime p_timeout) const {
+        return EventAwaiter{*this, p_event, true, p_timeout};
+    }
+
+    // Time the coroutine was last resumed at
+    StateTime time() const {
+        return m_currentTime;
+    }
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "statelayout.hpp"
+#include <algorithm>
+
+void StateLayoutProfile::record(const uint16_t p_from, const uint16_t p_to, const uint64_t p_count) {
+    if (p_from == p_to) {
+        return;
+    }
+
+    const uint32_t key = (uint32_t)p_from << 16 | p_to;
+    const std::unordered_map<uint32_t, size_t>::iterator found = m_index.find(key);
+
+    if (found == m_index.end()) {
+        m_index[key] = m_edges.size();
+        m_edges.push_back(StateLayoutEdge{p_from, p_to, p_count});
+    } else {
+        m_edges[found->second].m_count += p_count;
+    }
+}
+
+const std::vector<StateLayoutEdge>& StateLayoutProfile::edges() const {
+    return m_edges;
+}
+
+void StateLayoutProfile::clear() {
+    m_edges.clear();
+    m_index.clear();
+}
+
+std::vector<uint16_t> stateLayout(const size_t p_states, const std::vector<StateLayoutEdge>& p_edges) {
+    static const uint16_t NONE = 0xFFFF;
+    std::vector<StateLayoutEdge> edges;
+
+    for (const StateLayoutEdge& edge : p_edges) {
+        if (edge.m_from != edge.m_to && edge.m_from < p_states && edge.m_to < p_states && edge.m_count > 0) {
+            edges.push_back(edge);
+        }
+    }
+
+    // Ties keep the order of the profile so the layout does not depend on the sort
+    std::stable_sort(edges.begin(), edges.end(), [](const StateLayoutEdge & p_a, const StateLayoutEdge & p_b) {
+        return p_a.m_count > p_b.m_count;
+    });
+
+    // Every state starts as a chain of its own, head of a tail and tail of a head point to the other end of its chain
+    std::vector<uint16_t> next(p_states, NONE);
+    std::vector<uint16_t> previous(p_states, NONE);
+    std::vector<uint16_t> head(p_states);
+    std::vector<uint16_t> tail(p_states);
+
+    for (size_t i = 0; i < p_states; i++) {
+        head[i] = i;
+        tail[i] = i;
+    }
+
+    for (const StateLayoutEdge& edge : edges) {
+        // Only a tail can get a successor and only a head a predecessor, joining a chain to itself would make a loop
+        if (next[edge.m_from] != NONE || previous[edge.m_to] != NONE || head[edge.m_from] == edge.m_to) {
+            continue;
+        }
+
+        const uint16_t first = head[edge.m_from];
+        const uint16_t last = tail[edge.m_to];
+        next[edge.m_from] = edge.m_to;
+        previous[edge.m_to] = edge.m_from;
+        tail[first] = last;
+        head[last] = first;
+    }
+
+    std::vector<uint16_t> layout;
+    layout.reserve(p_states);
+    std::vector<bool> placed(p_states, false);
+
+    auto place = [&](const uint16_t p_state) {
+        if (placed[p_state]) {
+            return;
+        }
+
+        uint16_t state = p_state;
+
+        while (previous[state] != NONE) {
+            state = previous[state];
+        }
+
+        for (; state != NONE && !placed[state]; state = next[state]) {
+            placed[state] = true;
+            layout.push_back(state);
+        }
+    };
+
+    for (const StateLayoutEdge& edge : edges) {
+        place(edge.m_from);
+        place(edge.m_to);
+    }
+
+    for (size_t i = 0; i < p_states; i++) {
+        place(i);
+    }
+
+    return layout;
+}
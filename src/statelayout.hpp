@@ -0,0 +1,45 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * A transition between two states by their index and how often it was taken
+ */
+struct StateLayoutEdge {
+    uint16_t m_from;
+    uint16_t m_to;
+    uint64_t m_count;
+};
+
+/**
+ * Counts transitions between states by their index, the profile StateMachineDefinition::freeze() lays out states by.
+ *
+ * StateLayoutProfile profile;
+ * const StateId before = instance.state();
+ * definition.handle(instance);
+ * profile.record(before, instance.state());
+ */
+class StateLayoutProfile {
+    std::vector<StateLayoutEdge> m_edges;
+    // Index in m_edges by from << 16 | to
+    std::unordered_map<uint32_t, size_t> m_index;
+
+public:
+    // Counts p_count transitions from p_from to p_to, staying in a state is not counted
+    void record(const uint16_t p_from, const uint16_t p_to, const uint64_t p_count = 1);
+
+    // Counted transitions in the order they were first taken
+    const std::vector<StateLayoutEdge>& edges() const;
+
+    void clear();
+};
+
+/**
+ * Order to lay out states 0 up to p_states in so that states joined by frequent transitions are next to each other.
+ * Going from the most taken transition down, the chain of states ending in its source is joined with the chain
+ * starting at its target (Pettis-Hansen). Chains are placed hottest first, states that are never left or entered last.
+ * Returns the index of each state in layout order.
+ */
+std::vector<uint16_t> stateLayout(const size_t p_states, const std::vector<StateLayoutEdge>& p_edges);
@@ -1,35 +1,57 @@
 #include "statemachine.hpp"
+#include "eventqueue.hpp"
+#include "transitiontrace.hpp"
+#include "transitiontable.hpp"
+#include "transitionheatmap.hpp"
 
 #ifndef UNIT_TEST
 #include <Arduino.h>
 #else
 extern "C" uint32_t millis();
+extern "C" uint32_t micros();
 #endif
 
+const uint16_t State::NO_ID;
+
 State::State(const TRunFunction& p_run) :
-    m_run(p_run) {
+    m_run(p_run),
+    m_name(nullptr),
+    m_id(NO_ID)
+#if STATEMACHINE_PROFILE
+    , m_profile()
+#endif
+{
 }
 State::State() : State(nullptr) {
 }
 
-State* State::run(const uint32_t currentMillis) const {
+State* State::run(const StateTime currentMillis) const {
+    if (!m_run) {
+        return (State*)this;
+    }
+
     return m_run();
 }
 
-StateTimed::StateTimed(uint32_t p_forTime, const TRunFunction& p_run) :
+StateTimed::StateTimed(StateTime p_forTime, const TRunFunction& p_run) :
     State(p_run),
     m_forTime(p_forTime),
     m_startTime(0) {
 }
 
-StateTimed::StateTimed(uint32_t p_forTime) : StateTimed(p_forTime, nullptr) {
+StateTimed::StateTimed(StateTime p_forTime) : StateTimed(p_forTime, nullptr) {
 }
 
-void StateTimed::transitionStart(const uint32_t p_currentTime) const {
+void StateTimed::transitionStart(const StateTime p_currentTime) const {
     m_startTime = p_currentTime;
 }
 
-State* StateTimed::run(const uint32_t p_currentTime) const {
+bool StateTimed::deadline(const StateTime p_currentTime, StateTime& p_deadline) const {
+    p_deadline = m_startTime + m_forTime + 1;
+    return true;
+}
+
+State* StateTimed::run(const StateTime p_currentTime) const {
     if (p_currentTime - m_startTime > m_forTime) {
         // We reset the time in case we re-run this state again
         m_startTime = p_currentTime;
@@ -39,8 +61,30 @@ State* StateTimed::run(const uint32_t p_currentTime) const {
     return (State*)this;
 }
 
+StateIdle::StateIdle(const TRunFunction& p_run) :
+    State(p_run) {
+}
+
+StateIdle::StateIdle() : StateIdle(nullptr) {
+}
+
+bool StateIdle::deadline(const StateTime p_currentTime, StateTime& p_deadline) const {
+    return false;
+}
+
 StateMachine::StateMachine(State* p_first) :
-    m_currentState(p_first) {
+    m_currentState(p_first),
+    m_events(nullptr),
+    m_table(nullptr)
+#if STATEMACHINE_TRACE
+    , m_trace(nullptr)
+#endif
+#if STATEMACHINE_HEATMAP
+    , m_heatMap(nullptr)
+    , m_enteredAt(0)
+#endif
+    , m_maxHops(1),
+    m_hopLimitReached(false) {
 }
 
 StateMachine::~StateMachine() {
@@ -49,7 +93,14 @@ StateMachine::~StateMachine() {
 // Call start once after you created the state machine but as aclose as possible
 // to your loop function
 void StateMachine::start() const {
-    m_currentState->transitionStart(millis());
+    start(MillisClock::now());
+}
+
+void StateMachine::start(const StateTime p_currentTime) const {
+#if STATEMACHINE_HEATMAP
+    m_enteredAt = p_currentTime;
+#endif
+    State::enter(m_currentState, p_currentTime);
 }
 
 // Evaluates if the current state is the given state
@@ -57,26 +108,125 @@ bool StateMachine::current(const State* state_id) const {
     return m_currentState == state_id;
 }
 
+inline void StateMachine::transitioned(const State* p_previous, const StateTime p_currentTime) {
+#if STATEMACHINE_TRACE
+
+    if (m_trace != nullptr && p_previous != m_currentState) {
+        m_trace->record(p_currentTime, p_previous, m_currentState);
+    }
+
+#endif
+#if STATEMACHINE_HEATMAP
+
+    if (p_previous != m_currentState) {
+        if (m_heatMap != nullptr) {
+            m_heatMap->record(p_previous, m_currentState, p_currentTime - m_enteredAt);
+        }
+
+        m_enteredAt = p_currentTime;
+    }
+
+#endif
+}
+
 // Call in your loop function regularly
 void StateMachine::handle() {
-    const uint32_t currentMillis = millis();
-    State* newState = m_currentState->run(currentMillis);
-
-    // Test if we need to change state
-    if (m_currentState != newState) {
-        // When state isfound end the previous state and start the new state
-        m_currentState->transitionEnd(currentMillis);
-        m_currentState = newState;
-        m_currentState->transitionStart(currentMillis);
+    handle(MillisClock::now());
+}
+
+void StateMachine::handle(const StateTime p_currentTime) {
+    EventId event;
+    // Only the events queued now, a producer that keeps pushing must not keep the current state from running
+    size_t pending = m_events != nullptr ? m_events->size() : 0;
+
+    while (pending > 0 && m_events->pop(event)) {
+        dispatch(event, p_currentTime);
+        pending--;
     }
+
+    for (uint8_t hops = 0; hops < m_maxHops; hops++) {
+        State* previous = m_currentState;
+        m_currentState = State::handle(m_currentState, p_currentTime);
+        transitioned(previous, p_currentTime);
+
+        if (m_currentState == previous) {
+            m_hopLimitReached = false;
+            return;
+        }
+    }
+
+    m_hopLimitReached = m_maxHops > 1;
+}
+
+void StateMachine::setRunToCompletion(const uint8_t p_maxHops) {
+    m_maxHops = p_maxHops == 0 ? 1 : p_maxHops;
+}
+
+bool StateMachine::hopLimitReached() const {
+    return m_hopLimitReached;
+}
+
+bool StateMachine::nextDeadline(StateTime& p_deadline) const {
+    return nextDeadline(MillisClock::now(), p_deadline);
+}
+
+bool StateMachine::nextDeadline(const StateTime p_currentTime, StateTime& p_deadline) const {
+    return m_currentState->deadline(p_currentTime, p_deadline);
+}
+
+void StateMachine::dispatch(const EventId p_event) {
+    dispatch(p_event, MillisClock::now());
 }
 
+void StateMachine::dispatch(const EventId p_event, const StateTime p_currentTime) {
+    State* previous = m_currentState;
+    const TransitionTable::Transition* transition = m_table == nullptr ? nullptr : m_table->find(m_currentState, p_event);
+
+    if (transition != nullptr) {
+        if (transition->m_action) {
+            transition->m_action();
+        }
+
+        m_currentState = State::transition(m_currentState, transition->m_to, p_currentTime);
+    } else {
+        m_currentState = State::dispatch(m_currentState, p_event, p_currentTime);
+    }
+
+    transitioned(previous, p_currentTime);
+}
+
+void StateMachine::setEventQueue(EventQueue* p_events) {
+    m_events = p_events;
+}
+
+void StateMachine::setTransitionTable(const TransitionTable* p_table) {
+    m_table = p_table;
+}
+
+#if STATEMACHINE_TRACE
+void StateMachine::setTrace(TransitionTrace* p_trace) {
+    m_trace = p_trace;
+}
+#endif
+
+#if STATEMACHINE_HEATMAP
+void StateMachine::setHeatMap(TransitionHeatMap* p_heatMap) {
+    m_heatMap = p_heatMap;
+}
+#endif
+
 DeletingStateMachine::DeletingStateMachine(State* p_first, const std::vector<State*>& p_states) : 
   StateMachine(p_first),
   m_states(p_states) {
     
 }
 
+DeletingStateMachine::DeletingStateMachine(State* p_first, StateArena&& p_arena) :
+    StateMachine(p_first),
+    m_states(),
+    m_arena(std::move(p_arena)) {
+}
+
 DeletingStateMachine::~DeletingStateMachine() {
     for (State* s : m_states) {
         delete s;
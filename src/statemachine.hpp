@@ -1,31 +1,153 @@
 #pragma once
 #include <stdint.h>
-#include <functional>
 #include <vector>
+#include "inplacefunction.hpp"
+#include "statemachineclock.hpp"
+#include "statearena.hpp"
 
 #ifndef UNIT_TEST
 #include <Arduino.h>
 #else
 extern "C" uint32_t millis();
+extern "C" uint32_t micros();
 #endif
 
+/**
+ * Maximum number of events a StateEvents reacts to, define before including the library to change it
+ */
+#ifndef STATEMACHINE_MAX_EVENTS
+#define STATEMACHINE_MAX_EVENTS 4
+#endif
+
+/**
+ * Set STATEMACHINE_TRACE to 1 to be able to record transitions with StateMachine::setTrace()
+ * Without it all tracing code is compiled out
+ */
+#ifndef STATEMACHINE_TRACE
+#define STATEMACHINE_TRACE 0
+#endif
+
+/**
+ * Set STATEMACHINE_PROFILE to 1 to count per state how often it is entered, how long it stays active
+ * and how long its runnable takes, see State::profile() and stateprofile.hpp
+ * Without it all profiling code is compiled out
+ */
+#ifndef STATEMACHINE_PROFILE
+#define STATEMACHINE_PROFILE 0
+#endif
+
+/**
+ * Set STATEMACHINE_HEATMAP to 1 to be able to count transitions per edge with StateMachine::setHeatMap()
+ * Without it all heat map code is compiled out
+ */
+#ifndef STATEMACHINE_HEATMAP
+#define STATEMACHINE_HEATMAP 0
+#endif
+
+/**
+ * Per state counters, times spend in a state are in the unit of the time passed to handle(),
+ * run times in microseconds. The time of the current visit is added when the state is left.
+ */
+struct StateProfile {
+    uint32_t m_entries;
+    StateTime m_enteredAt;
+    uint64_t m_dwellTime;
+    StateTime m_maxDwellTime;
+    uint32_t m_runs;
+    uint64_t m_runTime;
+};
+
+/**
+ * Identifies an event that is dispatched to a StateMachine, see StateEvents
+ */
+typedef uint16_t EventId;
+
 /**
  * Simpel state that gets run each time the StateMachine reaches this state
+ * The runnable is stored inside the State, see STATEMACHINE_CAPTURE_SIZE for how much a lambda may capture
+ * A State without runnable stays in the same state
  */
 class State {
     friend class StateMachine;
+    friend class StateMachineGroup;
+    friend class TransitionTable;
 public:
-    typedef std::function<State* ()> TRunFunction;
+    typedef InplaceFunction<State* ()> TRunFunction;
+
+    // Id of a state that is not in a TransitionTable
+    static const uint16_t NO_ID = 0xFFFF;
 
 private:
     TRunFunction m_run;
+    const char* m_name;
+    uint16_t m_id;
+#if STATEMACHINE_PROFILE
+    mutable StateProfile m_profile;
+#endif
 
 private:
-    virtual void transitionStart(const uint32_t p_currentTime) const {}
-    virtual void transitionEnd(const uint32_t p_currentTime) const {}
+    virtual void transitionStart(const StateTime p_currentTime) const {}
+    virtual void transitionEnd(const StateTime p_currentTime) const {}
+
+    // Sets p_deadline to the first time at which run() can change state and returns true,
+    // returns false when it will never change state on its own. A State with runnable can change at any time.
+    virtual bool deadline(const StateTime p_currentTime, StateTime& p_deadline) const {
+        p_deadline = p_currentTime;
+        return static_cast<bool>(m_run);
+    }
+
+    // Returns the state to go to when p_event is dispatched, states that don't react return themselves
+    virtual State* react(const EventId p_event, const StateTime p_currentTime) const {
+        return (State*)this;
+    }
+
+    // Starts p_state as the first state of a machine
+    static inline void enter(State* p_state, const StateTime p_currentTime) {
+#if STATEMACHINE_PROFILE
+        p_state->m_profile.m_entries++;
+        p_state->m_profile.m_enteredAt = p_currentTime;
+#endif
+        p_state->transitionStart(p_currentTime);
+    }
+
+    // Moves from p_state to p_newState when they differ, returns the state to continue with
+    static inline State* transition(State* p_state, State* p_newState, const StateTime p_currentTime) {
+        // Test if we need to change state
+        if (p_state != p_newState) {
+            // When state isfound end the previous state and start the new state
+            p_state->transitionEnd(p_currentTime);
+#if STATEMACHINE_PROFILE
+            StateProfile& profile = p_state->m_profile;
+            const StateTime dwellTime = p_currentTime - profile.m_enteredAt;
+            profile.m_dwellTime += dwellTime;
+            profile.m_maxDwellTime = dwellTime > profile.m_maxDwellTime ? dwellTime : profile.m_maxDwellTime;
+#endif
+            enter(p_newState, p_currentTime);
+        }
+
+        return p_newState;
+    }
+
+    // Runs p_state and returns the state to continue with, transitions when needed
+    static inline State* handle(State* p_state, const StateTime p_currentTime) {
+#if STATEMACHINE_PROFILE
+        const uint32_t start = micros();
+        State* newState = p_state->run(p_currentTime);
+        p_state->m_profile.m_runs++;
+        p_state->m_profile.m_runTime += micros() - start;
+        return transition(p_state, newState, p_currentTime);
+#else
+        return transition(p_state, p_state->run(p_currentTime), p_currentTime);
+#endif
+    }
+
+    // Lets p_state react to p_event and returns the state to continue with, transitions when needed
+    static inline State* dispatch(State* p_state, const EventId p_event, const StateTime p_currentTime) {
+        return transition(p_state, p_state->react(p_event, p_currentTime), p_currentTime);
+    }
 
 protected:
-    virtual State* run(const uint32_t currentMillis) const;
+    virtual State* run(const StateTime currentMillis) const;
 
 public:
     State(const TRunFunction& p_run);
@@ -35,24 +157,109 @@ public:
     void setRunnable(const TRunFunction& p_run) {
         m_run = p_run;
     }
+
+    // Name used when printing traces and statistics, the string is not copied
+    void setName(const char* p_name) {
+        m_name = p_name;
+    }
+
+    const char* name() const {
+        return m_name;
+    }
+
+    // Position of this state in its TransitionTable, NO_ID when it is not in one
+    uint16_t id() const {
+        return m_id;
+    }
+
+#if STATEMACHINE_PROFILE
+    const StateProfile& profile() const {
+        return m_profile;
+    }
+
+    void resetProfile() {
+        m_profile = StateProfile();
+    }
+#endif
 };
 
 /**
  * State that will run after given time has passed
  */
 class StateTimed : public State {
-    const uint32_t m_forTime;
-    mutable uint32_t m_startTime;
+    const StateTime m_forTime;
+    mutable StateTime m_startTime;
+
+public:
+    StateTimed(const StateTime p_forTime, const TRunFunction& p_run);
+    StateTimed(const StateTime p_forTime);
+
+private:
+    virtual void transitionStart(const StateTime p_currentTime) const;
+    virtual bool deadline(const StateTime p_currentTime, StateTime& p_deadline) const;
+    virtual State* run(const StateTime p_currentTime) const;
+};
 
+/**
+ * State that waits for something outside the machine, like an interrupt or a network packet
+ * It's runnable is run on each handle() but StateMachine::nextDeadline() reports it never needs to be handled
+ */
+class StateIdle : public State {
 public:
-    StateTimed(const uint32_t p_forTime, const TRunFunction& p_run);
-    StateTimed(const uint32_t p_forTime);
+    StateIdle(const TRunFunction& p_run);
+    StateIdle();
 
 private:
-    virtual void transitionStart(const uint32_t p_currentTime) const;
-    virtual State* run(const uint32_t p_currentTime) const;
+    virtual bool deadline(const StateTime p_currentTime, StateTime& p_deadline) const;
 };
 
+/**
+ * Adds reactions to events to a state, by default to a StateIdle so the state costs nothing until an event arrives.
+ * Use StateEvents<StateTimed> to wait for an event with a timeout or StateEvents<State> to also poll.
+ * Events the state does not react to are ignored.
+ */
+template<typename Base = StateIdle, uint8_t Events = STATEMACHINE_MAX_EVENTS>
+class StateEvents : public Base {
+    struct Reaction {
+        EventId m_event;
+        State::TRunFunction m_run;
+    };
+
+    Reaction m_reactions[Events];
+    uint8_t m_count = 0;
+
+public:
+    using Base::Base;
+
+    // Run p_run when p_event is dispatched while in this state, returns false when this state can't react to more events
+    bool on(const EventId p_event, const State::TRunFunction& p_run) {
+        if (m_count == Events) {
+            return false;
+        }
+
+        m_reactions[m_count].m_event = p_event;
+        m_reactions[m_count].m_run = p_run;
+        m_count++;
+        return true;
+    }
+
+private:
+    virtual State* react(const EventId p_event, const StateTime p_currentTime) const {
+        for (uint8_t i = 0; i < m_count; i++) {
+            if (m_reactions[i].m_event == p_event) {
+                return m_reactions[i].m_run();
+            }
+        }
+
+        return (State*)this;
+    }
+};
+
+
+class EventQueue;
+class TransitionTrace;
+class TransitionTable;
+class TransitionHeatMap;
 
 /**
  * StateMachine itself that will run through all states
@@ -61,6 +268,21 @@ private:
 class StateMachine {
 private:
     State* m_currentState;
+    EventQueue* m_events;
+    const TransitionTable* m_table;
+#if STATEMACHINE_TRACE
+    TransitionTrace* m_trace;
+#endif
+#if STATEMACHINE_HEATMAP
+    TransitionHeatMap* m_heatMap;
+    // When the current state was entered, start() sets it too
+    mutable StateTime m_enteredAt;
+#endif
+    uint8_t m_maxHops;
+    bool m_hopLimitReached;
+
+    // Called after every handle() and dispatch(), records the transition when the state changed
+    void transitioned(const State* p_previous, const StateTime p_currentTime);
 public:
     StateMachine(State* p_first);
 
@@ -70,19 +292,103 @@ public:
     // to your loop function
     void start() const;
 
+    // Same as start() with a time you already have
+    void start(const StateTime p_currentTime) const;
+
     // Evaluates if the current state is the given state
     bool current(const State* state_id) const;
 
     // Call in your loop function regularly
     void handle();
 
+    // Same as handle() with a time you already have
+    void handle(const StateTime p_currentTime);
+
+    // Lets handle() run newly entered states in the same call until a state stays, like a StateTimed that starts
+    // waiting, or until p_maxHops transitions were made. The default of 1 makes one transition per handle().
+    void setRunToCompletion(const uint8_t p_maxHops);
+
+    // True when the last handle() stopped at the hop limit of setRunToCompletion(), which points to a cycle of states
+    bool hopLimitReached() const;
+
+    // Sets p_deadline to the earliest time at which handle() could change state and returns true.
+    // That is now for a State and the end of the wait for a StateTimed, which can be in the past when handle() was late.
+    // Returns false when the machine is in a StateIdle and only something outside the machine can change it.
+    bool nextDeadline(StateTime& p_deadline) const;
+
+    // Same as nextDeadline() with a time you already have
+    bool nextDeadline(const StateTime p_currentTime, StateTime& p_deadline) const;
+
+    // Lets the current state react to p_event, see StateEvents. Don't call from a runnable of this machine.
+    void dispatch(const EventId p_event);
+
+    // Same as dispatch() with a time you already have
+    void dispatch(const EventId p_event, const StateTime p_currentTime);
+
+    // Events pushed to p_events from other threads are dispatched on each handle() before the current state is run
+    // The machine does not own the queue, pass nullptr to detach it
+    void setEventQueue(EventQueue* p_events);
+
+    // Events are looked up in p_table first, events without a transition in the table go to the state as before
+    // The machine does not own the table, pass nullptr to detach it
+    void setTransitionTable(const TransitionTable* p_table);
+
+#if STATEMACHINE_TRACE
+    // Records all transitions in p_trace, the machine does not own the trace. Pass nullptr to stop recording.
+    void setTrace(TransitionTrace* p_trace);
+#endif
+
+#if STATEMACHINE_HEATMAP
+    // Counts all transitions in p_heatMap, the machine does not own the heat map. Pass nullptr to stop counting.
+    void setHeatMap(TransitionHeatMap* p_heatMap);
+#endif
+
 };
 
+/**
+ * StateMachine that reads the time from Clock instead of millis(), see statemachineclock.hpp
+ * The clock is called directly and can be inlined.
+ *
+ * ClockedStateMachine<SteadyClock<std::chrono::microseconds>> machine{&first};
+ */
+template<typename Clock>
+class ClockedStateMachine : public StateMachine {
+public:
+    using StateMachine::StateMachine;
+    using StateMachine::start;
+    using StateMachine::handle;
+    using StateMachine::nextDeadline;
+    using StateMachine::dispatch;
+
+    void start() const {
+        StateMachine::start(Clock::now());
+    }
+
+    void handle() {
+        StateMachine::handle(Clock::now());
+    }
+
+    bool nextDeadline(StateTime& p_deadline) const {
+        return StateMachine::nextDeadline(Clock::now(), p_deadline);
+    }
+
+    void dispatch(const EventId p_event) {
+        StateMachine::dispatch(p_event, Clock::now());
+    }
+};
+
+/**
+ * StateMachine that owns its states, either states created with new or states created in a StateArena
+ */
 class DeletingStateMachine :public StateMachine{
 private:
     const std::vector<State*> m_states;
+    StateArena m_arena;
 public:
     DeletingStateMachine(State* p_first, const std::vector<State*>& m_states);
 
+    // Takes over p_arena, all states in it are destroyed with the machine in one step
+    DeletingStateMachine(State* p_first, StateArena&& p_arena);
+
     virtual ~DeletingStateMachine();
 };
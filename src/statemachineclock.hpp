@@ -0,0 +1,98 @@
+#pragma once
+#include <stdint.h>
+#include <type_traits>
+
+#ifndef UNIT_TEST
+#include <Arduino.h>
+#else
+extern "C" uint32_t millis();
+extern "C" uint32_t micros();
+#endif
+
+#if !defined(ARDUINO) || defined(ESP32)
+#include <atomic>
+#include <chrono>
+#endif
+
+/**
+ * Type of all times passed to handle() and used by StateTimed, define before including the library to change it.
+ * The unit is whatever the clock gives, milliseconds for millis(). With uint32_t milliseconds time wraps after
+ * 49.7 days, which is handled, but waits can not be longer than half of that. Use -DSTATEMACHINE_TIME_TYPE=uint64_t
+ * for longer waits or clocks in micro- or nanoseconds. The 32 bit millis() and micros() are then widened to 64 bit
+ * by MillisClock and MicrosClock, which all calls without a time use.
+ */
+#ifndef STATEMACHINE_TIME_TYPE
+#define STATEMACHINE_TIME_TYPE uint32_t
+#endif
+
+typedef STATEMACHINE_TIME_TYPE StateTime;
+static_assert(std::is_unsigned<StateTime>::value, "STATEMACHINE_TIME_TYPE must be an unsigned integer");
+
+// Difference between two times, positive when the first is later, also when the time wrapped in between
+inline typename std::make_signed<StateTime>::type stateTimeDiff(const StateTime p_time, const StateTime p_since) {
+    return static_cast<typename std::make_signed<StateTime>::type>(p_time - p_since);
+}
+
+namespace statemachine_detail {
+
+#if !defined(ARDUINO) || defined(ESP32)
+typedef std::atomic<StateTime> TLastTime;
+#else
+// No threads, only called outside of interrupts
+typedef StateTime TLastTime;
+#endif
+
+/**
+ * Widens the 32 bit readings of Clock::ticks() to StateTime by adding the distance to the previous reading,
+ * so a 64 bit time keeps counting when the clock wraps. Has to be read at least once every 2^31 ticks,
+ * 24 days of millis() or 35 minutes of micros(). A 32 bit StateTime gets the reading as is.
+ */
+template<typename Clock>
+inline StateTime widenedTime() {
+    if (sizeof(StateTime) <= sizeof(uint32_t)) {
+        return Clock::ticks();
+    }
+
+    static TLastTime last{static_cast<StateTime>(Clock::ticks())};
+    const StateTime previous = last;
+    const uint32_t ticks = Clock::ticks();
+    const StateTime now = previous + static_cast<StateTime>(static_cast<int32_t>(ticks - static_cast<uint32_t>(previous)));
+    // Threads may overwrite a slightly later reading of each other, any reading within 2^31 ticks works
+    last = now;
+    return now;
+}
+
+}
+
+/**
+ * Clock policies for ClockedStateMachine, a clock is a type with a static now() that returns a StateTime
+ */
+struct MillisClock {
+    static inline uint32_t ticks() {
+        return millis();
+    }
+
+    static inline StateTime now() {
+        return statemachine_detail::widenedTime<MillisClock>();
+    }
+};
+
+struct MicrosClock {
+    static inline uint32_t ticks() {
+        return micros();
+    }
+
+    static inline StateTime now() {
+        return statemachine_detail::widenedTime<MicrosClock>();
+    }
+};
+
+#if !defined(ARDUINO) || defined(ESP32)
+// std::chrono::steady_clock in the given unit, use a 64 bit StateTime for nanoseconds
+template<typename Duration = std::chrono::microseconds>
+struct SteadyClock {
+    static inline StateTime now() {
+        return static_cast<StateTime>(std::chrono::duration_cast<Duration>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+};
+#endif
@@ -0,0 +1,102 @@
+#include "statemachinedefinition.hpp"
+
+StateId StateMachineDefinition::add(const StateTiming::Kind p_kind, const StateTime p_forTime, const TRunFunction& p_run) {
+    if (m_frozen) {
+        m_slots.push_back(m_states.size());
+    }
+
+    m_states.push_back(Definition{p_run, StateTiming{p_forTime, p_kind}, nullptr});
+    return m_states.size() - 1;
+}
+
+StateId StateMachineDefinition::add(const TRunFunction& p_run) {
+    return add(StateTiming::KIND_STATE, 0, p_run);
+}
+
+StateId StateMachineDefinition::addTimed(const StateTime p_forTime, const TRunFunction& p_run) {
+    return add(StateTiming::KIND_TIMED, p_forTime, p_run);
+}
+
+StateId StateMachineDefinition::addIdle(const TRunFunction& p_run) {
+    return add(StateTiming::KIND_IDLE, 0, p_run);
+}
+
+void StateMachineDefinition::setRunnable(const StateId p_state, const TRunFunction& p_run) {
+    m_states[slot(p_state)].m_run = p_run;
+}
+
+void StateMachineDefinition::setName(const StateId p_state, const char* p_name) {
+    m_states[slot(p_state)].m_name = p_name;
+}
+
+const char* StateMachineDefinition::name(const StateId p_state) const {
+    return m_states[slot(p_state)].m_name;
+}
+
+size_t StateMachineDefinition::size() const {
+    return m_states.size();
+}
+
+void StateMachineDefinition::freeze(const std::vector<StateLayoutEdge>& p_profile) {
+    const std::vector<uint16_t> order = stateLayout(m_states.size(), p_profile);
+    std::vector<Definition> states;
+    states.reserve(m_states.size());
+    std::vector<StateId> slots(m_states.size());
+
+    for (const uint16_t id : order) {
+        states.push_back(m_states[slot(id)]);
+        slots[id] = states.size() - 1;
+    }
+
+    m_slots.swap(slots);
+    m_frozen = true;
+
+    m_states.swap(states);
+}
+
+std::vector<StateId> StateMachineDefinition::layout() const {
+    std::vector<StateId> ids(m_states.size());
+
+    for (size_t id = 0; id < m_states.size(); id++) {
+        ids[slot(id)] = id;
+    }
+
+    return ids;
+}
+
+void StateMachineDefinition::start(StateMachineInstance& p_instance, const StateId p_first) const {
+    start(p_instance, p_first, MillisClock::now());
+}
+
+void StateMachineDefinition::start(StateMachineInstance& p_instance, const StateId p_first, const StateTime p_currentTime) const {
+    p_instance.m_state = p_first;
+    p_instance.m_startTime = p_currentTime;
+}
+
+void StateMachineDefinition::handle(StateMachineInstance& p_instance) const {
+    handle(p_instance, MillisClock::now());
+}
+
+void StateMachineDefinition::handle(StateMachineInstance& p_instance, const StateTime p_currentTime) const {
+    const Definition& state = m_states[slot(p_instance.m_state)];
+
+    if (!state.m_timing.due(p_instance.m_startTime, p_currentTime) || !state.m_run) {
+        return;
+    }
+
+    const StateId next = state.m_run(p_instance);
+
+    if (next != p_instance.m_state) {
+        p_instance.m_state = next;
+        p_instance.m_startTime = p_currentTime;
+    }
+}
+
+bool StateMachineDefinition::nextDeadline(const StateMachineInstance& p_instance, StateTime& p_deadline) const {
+    return nextDeadline(p_instance, MillisClock::now(), p_deadline);
+}
+
+bool StateMachineDefinition::nextDeadline(const StateMachineInstance& p_instance, const StateTime p_currentTime, StateTime& p_deadline) const {
+    const Definition& state = m_states[slot(p_instance.m_state)];
+    return state.m_timing.deadline(p_instance.m_startTime, p_currentTime, static_cast<bool>(state.m_run), p_deadline);
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "inplacefunction.hpp"
+#include "statemachineclock.hpp"
+#include "statelayout.hpp"
+#include "statetiming.hpp"
+
+#ifndef UNIT_TEST
+#include <Arduino.h>
+#else
+extern "C" uint32_t millis();
+#endif
+
+/**
+ * Id of a state within a StateMachineDefinition, ids are handed out in the order states are added
+ */
+typedef uint16_t StateId;
+
+/**
+ * Per machine data of a machine that runs a shared StateMachineDefinition.
+ * This is all a machine needs on its own: the current state and when it was entered.
+ */
+class StateMachineInstance {
+    friend class StateMachineDefinition;
+    friend class StateMachineImage;
+
+    StateId m_state;
+    StateTime m_startTime;
+
+public:
+    StateMachineInstance() :
+        m_state(0),
+        m_startTime(0) {
+    }
+
+    StateId state() const {
+        return m_state;
+    }
+
+    // Time at which the current state was entered, or at which a StateTimed wait was restarted
+    StateTime startTime() const {
+        return m_startTime;
+    }
+};
+
+/**
+ * States and runnables shared by any number of machines, the flyweight version of a set of State objects.
+ * Runnables get the instance they run for and return the id of the next state, they must not keep
+ * per machine data in their captures. Once all states are added the definition is only read, so one
+ * definition can run instances on several threads at the same time as long as each instance is
+ * handled by one thread at a time.
+ *
+ * StateMachineDefinition blink;
+ * const StateId on = blink.addTimed(500);
+ * const StateId off = blink.addTimed(500);
+ * blink.setRunnable(on, [off](const StateMachineInstance&) { return off; });
+ * blink.setRunnable(off, [on](const StateMachineInstance&) { return on; });
+ * std::vector<StateMachineInstance> leds(10000);
+ * for (auto& led : leds) blink.start(led, on);
+ */
+class StateMachineDefinition {
+public:
+    typedef InplaceFunction<StateId(const StateMachineInstance&)> TRunFunction;
+
+private:
+    struct Definition {
+        TRunFunction m_run;
+        StateTiming m_timing;
+        const char* m_name;
+    };
+
+    // In layout order, m_slots has the position of each state id once m_frozen, before that ids are positions
+    std::vector<Definition> m_states;
+    std::vector<StateId> m_slots;
+    bool m_frozen = false;
+
+    StateId add(const StateTiming::Kind p_kind, const StateTime p_forTime, const TRunFunction& p_run);
+
+    // Returns the position of p_state in m_states, without an extra load while not frozen
+    size_t slot(const StateId p_state) const {
+        return m_frozen ? m_slots[p_state] : p_state;
+    }
+
+public:
+    // Adds a state that runs its runnable on every handle(), like State
+    StateId add(const TRunFunction& p_run = nullptr);
+
+    // Adds a state that runs its runnable once p_forTime has passed, like StateTimed
+    StateId addTimed(const StateTime p_forTime, const TRunFunction& p_run = nullptr);
+
+    // Adds a state that only changes by something outside the machine, like StateIdle
+    StateId addIdle(const TRunFunction& p_run = nullptr);
+
+    // Sets the runnable of an added state, use it when states refer to each other
+    void setRunnable(const StateId p_state, const TRunFunction& p_run);
+
+    void setName(const StateId p_state, const char* p_name);
+    const char* name(const StateId p_state) const;
+
+    // Number of states
+    size_t size() const;
+
+    // Re-lays out the states so the states of the most taken transitions in p_profile are next to each other in
+    // memory, see stateLayout(). Ids stay the same. Call once all states are added, before handling instances
+    // on other threads. States added later are placed at the end.
+    void freeze(const std::vector<StateLayoutEdge>& p_profile);
+
+    // State ids in the order the states are in memory
+    std::vector<StateId> layout() const;
+
+    // Puts p_instance in p_first, call once for each instance before handling it
+    void start(StateMachineInstance& p_instance, const StateId p_first) const;
+    void start(StateMachineInstance& p_instance, const StateId p_first, const StateTime p_currentTime) const;
+
+    // Runs the current state of p_instance
+    void handle(StateMachineInstance& p_instance) const;
+    void handle(StateMachineInstance& p_instance, const StateTime p_currentTime) const;
+
+    // Same as StateMachine::nextDeadline() for p_instance
+    bool nextDeadline(const StateMachineInstance& p_instance, StateTime& p_deadline) const;
+    bool nextDeadline(const StateMachineInstance& p_instance, const StateTime p_currentTime, StateTime& p_deadline) const;
+};
@@ -0,0 +1,429 @@
+#include "statemachinedescription.hpp"
+#include <algorithm>
+
+const StateId StateMachineDescription::NONE;
+
+namespace {
+
+/**
+ * Reads the subset of JSON a description needs: objects, arrays, strings without unicode escapes,
+ * unsigned integers, true, false and null
+ */
+class JsonReader {
+    // Deepest nesting of skipped values, the stack of a device is small
+    static const uint8_t MAX_DEPTH = 16;
+
+    const char* m_begin;
+    const char* m_at;
+    std::string m_error;
+    uint8_t m_depth;
+
+public:
+    JsonReader(const char* p_text) :
+        m_begin(p_text),
+        m_at(p_text),
+        m_depth(0) {
+    }
+
+    const std::string& error() const {
+        return m_error;
+    }
+
+    bool fail(const std::string& p_message) {
+        if (m_error.empty()) {
+            m_error = p_message + " at offset " + std::to_string(m_at - m_begin);
+        }
+
+        return false;
+    }
+
+    void space() {
+        while (*m_at == ' ' || *m_at == '\t' || *m_at == '\n' || *m_at == '\r') {
+            m_at++;
+        }
+    }
+
+    // True when p_char is next, without skipping it
+    bool next(const char p_char) {
+        space();
+        return *m_at == p_char;
+    }
+
+    // Skips p_char when it is next
+    bool accept(const char p_char) {
+        space();
+
+        if (*m_at != p_char) {
+            return false;
+        }
+
+        m_at++;
+        return true;
+    }
+
+    bool expect(const char p_char) {
+        return accept(p_char) || fail(std::string("Expected '") + p_char + "'");
+    }
+
+    bool end() {
+        space();
+        return *m_at == '\0' || fail("Unexpected text after the description");
+    }
+
+    bool string(std::string& p_value) {
+        if (!expect('"')) {
+            return false;
+        }
+
+        p_value.clear();
+
+        while (*m_at != '"') {
+            if (*m_at == '\0') {
+                return fail("Unterminated string");
+            }
+
+            if (*m_at == '\\') {
+                m_at++;
+
+                switch (*m_at) {
+                    case '"':
+                    case '\\':
+                    case '/':
+                        p_value += *m_at;
+                        break;
+
+                    case 'n':
+                        p_value += '\n';
+                        break;
+
+                    case 't':
+                        p_value += '\t';
+                        break;
+
+                    default:
+                        return fail("Unsupported escape in string");
+                }
+            } else {
+                p_value += *m_at;
+            }
+
+            m_at++;
+        }
+
+        m_at++;
+        return true;
+    }
+
+    bool number(uint32_t& p_value, const uint32_t p_max) {
+        space();
+
+        if (*m_at < '0' || *m_at > '9') {
+            return fail("Expected a number");
+        }
+
+        uint64_t value = 0;
+
+        while (*m_at >= '0' && *m_at <= '9') {
+            value = value * 10 + (*m_at - '0');
+
+            if (value > p_max) {
+                return fail("Number out of range");
+            }
+
+            m_at++;
+        }
+
+        p_value = value;
+        return true;
+    }
+
+    // Skips any value, used for keys the description does not know
+    bool skip() {
+        space();
+
+        if (*m_at == '"') {
+            std::string ignored;
+            return string(ignored);
+        }
+
+        if (*m_at == '{' || *m_at == '[') {
+            if (m_depth == MAX_DEPTH) {
+                return fail("Nested too deep");
+            }
+
+            m_depth++;
+            const bool skipped = *m_at == '{' ? object([this](const std::string&) {
+                return skip();
+            }) : array([this]() {
+                return skip();
+            });
+            m_depth--;
+            return skipped;
+        }
+
+        const char* start = m_at;
+
+        while ((*m_at >= '0' && *m_at <= '9') || (*m_at >= 'a' && *m_at <= 'z') || *m_at == '-' || *m_at == '.' || *m_at == '+' || *m_at == 'E') {
+            m_at++;
+        }
+
+        return m_at != start || fail("Expected a value");
+    }
+
+    // Calls p_member for every key, p_member reads the value
+    template<typename F>
+    bool object(F p_member) {
+        if (!expect('{')) {
+            return false;
+        }
+
+        if (accept('}')) {
+            return true;
+        }
+
+        do {
+            std::string key;
+
+            if (!string(key) || !expect(':') || !p_member(key)) {
+                return false;
+            }
+        } while (accept(','));
+
+        return expect('}');
+    }
+
+    // Calls p_element for every element, p_element reads it
+    template<typename F>
+    bool array(F p_element) {
+        if (!expect('[')) {
+            return false;
+        }
+
+        if (accept(']')) {
+            return true;
+        }
+
+        do {
+            if (!p_element()) {
+                return false;
+            }
+        } while (accept(','));
+
+        return expect(']');
+    }
+};
+
+struct ParsedTransition {
+    std::string m_event;
+    uint32_t m_eventId;
+    std::string m_to;
+    std::string m_guard;
+    std::string m_action;
+};
+
+struct ParsedState {
+    std::string m_name;
+    bool m_hasTimeout;
+    uint32_t m_timeout;
+    std::string m_timeoutTo;
+    std::string m_timeoutAction;
+    std::vector<ParsedTransition> m_transitions;
+};
+
+}
+
+StateMachineDescription::StateMachineDescription() :
+    m_initial(0) {
+}
+
+bool StateMachineDescription::parse(const char* p_text, std::string* p_error) {
+    JsonReader reader{p_text};
+    std::string initial;
+    std::vector<ParsedState> states;
+    std::vector<Event> events;
+
+    const bool parsed = reader.object([&](const std::string & p_key) {
+        if (p_key == "initial") {
+            return reader.string(initial);
+        }
+
+        if (p_key == "events") {
+            return reader.object([&](const std::string & p_event) {
+                uint32_t id = 0;
+                const bool read = reader.number(id, 0xFFFF);
+                events.push_back(Event{p_event, static_cast<EventId>(id)});
+                return read;
+            });
+        }
+
+        if (p_key != "states") {
+            return reader.skip();
+        }
+
+        return reader.array([&]() {
+            states.push_back(ParsedState{"", false, 0, "", "", {}});
+            ParsedState& state = states.back();
+
+            return reader.object([&](const std::string & p_stateKey) {
+                if (p_stateKey == "name") {
+                    return reader.string(state.m_name);
+                }
+
+                if (p_stateKey == "timeout") {
+                    state.m_hasTimeout = true;
+                    return reader.object([&](const std::string & p_timeoutKey) {
+                        if (p_timeoutKey == "after") {
+                            return reader.number(state.m_timeout, 0xFFFFFFFF);
+                        }
+
+                        if (p_timeoutKey == "to") {
+                            return reader.string(state.m_timeoutTo);
+                        }
+
+                        return p_timeoutKey == "action" ? reader.string(state.m_timeoutAction) : reader.skip();
+                    });
+                }
+
+                if (p_stateKey != "on") {
+                    return reader.skip();
+                }
+
+                return reader.array([&]() {
+                    state.m_transitions.push_back(ParsedTransition{"", 0xFFFFFFFF, "", "", ""});
+                    ParsedTransition& transition = state.m_transitions.back();
+
+                    return reader.object([&](const std::string & p_transitionKey) {
+                        if (p_transitionKey == "event") {
+                            return reader.next('"') ? reader.string(transition.m_event) : reader.number(transition.m_eventId, 0xFFFF);
+                        }
+
+                        if (p_transitionKey == "to") {
+                            return reader.string(transition.m_to);
+                        }
+
+                        if (p_transitionKey == "guard") {
+                            return reader.string(transition.m_guard);
+                        }
+
+                        return p_transitionKey == "action" ? reader.string(transition.m_action) : reader.skip();
+                    });
+                });
+            });
+        });
+    }) && reader.end();
+
+    std::string error = reader.error();
+
+    if (parsed && (states.empty() || states.size() >= NONE)) {
+        error = "A description needs 1 up to 65534 states";
+    }
+
+    for (size_t i = 0; parsed && error.empty() && i < states.size(); i++) {
+        bool unique = !states[i].m_name.empty();
+
+        for (size_t j = 0; j < i; j++) {
+            unique = unique && states[j].m_name != states[i].m_name;
+        }
+
+        if (!unique) {
+            error = "State " + std::to_string(i) + " has no name or the name of another state";
+        }
+    }
+
+    // Sets p_id to the state named p_name
+    auto resolve = [&](const std::string & p_name, StateId & p_id, const std::string & p_where) {
+        for (size_t i = 0; i < states.size(); i++) {
+            if (states[i].m_name == p_name) {
+                p_id = i;
+                return true;
+            }
+        }
+
+        if (error.empty()) {
+            error = p_where + " goes to unknown state '" + p_name + "'";
+        }
+
+        return false;
+    };
+
+    StateId initialId = 0;
+
+    if (parsed && error.empty() && !initial.empty()) {
+        resolve(initial, initialId, "The initial state");
+    }
+
+    std::vector<State> resolved;
+
+    for (size_t i = 0; parsed && error.empty() && i < states.size(); i++) {
+        const ParsedState& state = states[i];
+        resolved.push_back(State{state.m_name, state.m_timeout, NONE, state.m_timeoutAction, {}});
+
+        if (state.m_hasTimeout) {
+            resolve(state.m_timeoutTo, resolved.back().m_timeoutTo, "The timeout of " + state.m_name);
+        }
+
+        for (const ParsedTransition& transition : state.m_transitions) {
+            uint32_t event = transition.m_eventId;
+
+            for (const Event& named : events) {
+                if (!transition.m_event.empty() && named.m_name == transition.m_event) {
+                    event = named.m_id;
+                }
+            }
+
+            if (event > 0xFFFF && error.empty()) {
+                error = "A transition of " + state.m_name + " has no event or an unknown event";
+            }
+
+            resolved.back().m_transitions.push_back(Transition{static_cast<EventId>(event), 0, transition.m_guard, transition.m_action});
+            resolve(transition.m_to, resolved.back().m_transitions.back().m_to, "A transition of " + state.m_name);
+        }
+    }
+
+    if (!parsed || !error.empty()) {
+        if (p_error != nullptr) {
+            *p_error = error;
+        }
+
+        return false;
+    }
+
+    m_states.swap(resolved);
+    m_events.swap(events);
+    m_initial = initialId;
+    return true;
+}
+
+const std::vector<StateMachineDescription::State>& StateMachineDescription::states() const {
+    return m_states;
+}
+
+const std::vector<StateMachineDescription::Event>& StateMachineDescription::events() const {
+    return m_events;
+}
+
+StateId StateMachineDescription::initial() const {
+    return m_initial;
+}
+
+std::vector<std::string> StateMachineDescription::callbacks() const {
+    std::vector<std::string> callbacks;
+
+    // Adds p_name when it is new
+    auto add = [&callbacks](const std::string & p_name) {
+        if (!p_name.empty() && std::find(callbacks.begin(), callbacks.end(), p_name) == callbacks.end()) {
+            callbacks.push_back(p_name);
+        }
+    };
+
+    for (const State& state : m_states) {
+        add(state.m_timeoutAction);
+
+        for (const Transition& transition : state.m_transitions) {
+            add(transition.m_guard);
+            add(transition.m_action);
+        }
+    }
+
+    return callbacks;
+}
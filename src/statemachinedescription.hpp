@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "statemachine.hpp"
+#include "statemachinedefinition.hpp"
+
+/**
+ * A machine graph read from JSON, the input of StateMachineImage::compile() and of the statemachinegen code generator.
+ *
+ * {
+ *   "initial": "idle",
+ *   "events": {"CONNECT": 1, "CONNECTED": 2, "DISCONNECTED": 3},
+ *   "states": [
+ *     {"name": "idle", "on": [{"event": "CONNECT", "to": "connecting", "action": "connect"}]},
+ *     {"name": "connecting", "timeout": {"after": 5000, "to": "idle"},
+ *      "on": [{"event": "CONNECTED", "to": "connected", "guard": "linkUp"}]},
+ *     {"name": "connected", "on": [{"event": 3, "to": "idle"}]}
+ *   ]
+ * }
+ *
+ * Events are numbers or names from "events", the initial state defaults to the first state.
+ * Unknown keys are skipped so descriptions can carry comments.
+ */
+class StateMachineDescription {
+public:
+    static const StateId NONE = 0xFFFF;
+
+    struct Transition {
+        EventId m_event;
+        StateId m_to;
+        std::string m_guard;
+        std::string m_action;
+    };
+
+    struct State {
+        std::string m_name;
+        uint32_t m_timeout;
+        // NONE when the state has no timeout
+        StateId m_timeoutTo;
+        std::string m_timeoutAction;
+        // In the order of the description
+        std::vector<Transition> m_transitions;
+    };
+
+    struct Event {
+        std::string m_name;
+        EventId m_id;
+    };
+
+private:
+    std::vector<State> m_states;
+    std::vector<Event> m_events;
+    StateId m_initial;
+
+public:
+    StateMachineDescription();
+
+    // Reads a JSON description, returns false and sets p_error when it is invalid
+    bool parse(const char* p_text, std::string* p_error = nullptr);
+
+    const std::vector<State>& states() const;
+
+    // Named events, in the order of the description
+    const std::vector<Event>& events() const;
+
+    StateId initial() const;
+
+    // Names of the guards and actions in the order they are first used
+    std::vector<std::string> callbacks() const;
+};
@@ -0,0 +1,160 @@
+// std::thread is not available on most Arduino platforms
+#if !defined(ARDUINO) || defined(ESP32)
+
+#include "statemachineexecutor.hpp"
+
+#ifndef UNIT_TEST
+#include <Arduino.h>
+#else
+extern "C" uint32_t millis();
+#endif
+
+StateMachineExecutor::StateMachineExecutor(const size_t p_threads, const size_t p_chunkSize) :
+    m_chunkSize(p_chunkSize == 0 ? 1 : p_chunkSize),
+    m_round(0),
+    m_busy(0),
+    m_stop(false),
+    m_currentTime(0) {
+    const size_t threads = p_threads == 0 ? 1 : p_threads;
+
+    for (size_t i = 0; i < threads; i++) {
+        m_workers.emplace_back(new Worker);
+    }
+
+    // Worker 0 is the thread calling handle()
+    for (size_t i = 1; i < threads; i++) {
+        m_threads.emplace_back(&StateMachineExecutor::loop, this, i);
+    }
+}
+
+StateMachineExecutor::~StateMachineExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_stop = true;
+    }
+    m_start.notify_all();
+
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void StateMachineExecutor::add(StateMachine* p_machine) {
+    m_machines.push_back(p_machine);
+}
+
+size_t StateMachineExecutor::size() const {
+    return m_machines.size();
+}
+
+size_t StateMachineExecutor::threads() const {
+    return m_workers.size();
+}
+
+bool StateMachineExecutor::take(const size_t p_worker, uint32_t& p_chunk) {
+    {
+        // Own chunks are taken from the front
+        Worker& own = *m_workers[p_worker];
+        std::lock_guard<std::mutex> lock(own.m_lock);
+
+        if (own.m_head != own.m_tail) {
+            p_chunk = own.m_chunks[own.m_head++];
+            return true;
+        }
+    }
+
+    // Steal from the back of the others, so the owner and thief don't fight over the same end
+    for (size_t i = 1; i < m_workers.size(); i++) {
+        Worker& victim = *m_workers[(p_worker + i) % m_workers.size()];
+        std::lock_guard<std::mutex> lock(victim.m_lock);
+
+        if (victim.m_head != victim.m_tail) {
+            p_chunk = victim.m_chunks[--victim.m_tail];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void StateMachineExecutor::work(const size_t p_worker) {
+    uint32_t chunk;
+
+    while (take(p_worker, chunk)) {
+        const size_t begin = chunk * m_chunkSize;
+        const size_t end = begin + m_chunkSize < m_machines.size() ? begin + m_chunkSize : m_machines.size();
+
+        for (size_t i = begin; i < end; i++) {
+            m_machines[i]->handle(m_currentTime);
+        }
+    }
+}
+
+void StateMachineExecutor::loop(const size_t p_worker) {
+    uint32_t round = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_start.wait(lock, [this, round]() {
+                return m_stop || m_round != round;
+            });
+
+            if (m_stop) {
+                return;
+            }
+
+            round = m_round;
+        }
+
+        work(p_worker);
+
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            if (--m_busy == 0) {
+                m_done.notify_one();
+            }
+        }
+    }
+}
+
+void StateMachineExecutor::handle() {
+    handle(MillisClock::now());
+}
+
+void StateMachineExecutor::handle(const StateTime p_currentTime) {
+    const size_t chunks = (m_machines.size() + m_chunkSize - 1) / m_chunkSize;
+    const size_t workers = m_workers.size();
+
+    // Give every worker an equal share of neighbouring chunks
+    for (size_t w = 0; w < workers; w++) {
+        Worker& worker = *m_workers[w];
+        std::lock_guard<std::mutex> lock(worker.m_lock);
+        worker.m_chunks.clear();
+
+        for (size_t chunk = chunks * w / workers; chunk < chunks * (w + 1) / workers; chunk++) {
+            worker.m_chunks.push_back(chunk);
+        }
+
+        worker.m_head = 0;
+        worker.m_tail = worker.m_chunks.size();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_currentTime = p_currentTime;
+        m_busy = m_threads.size();
+        m_round++;
+    }
+    m_start.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_done.wait(lock, [this]() {
+        return m_busy == 0;
+    });
+}
+
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+
+// std::thread is not available on most Arduino platforms
+#if !defined(ARDUINO) || defined(ESP32)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "statemachine.hpp"
+
+/**
+ * Handles a large number of machines on several threads.
+ * Each handle() splits the machines in chunks that are spread over the threads, a thread
+ * that runs out of work steals chunks from the others. Every machine is handled exactly once
+ * per handle() by one thread, so the states of a machine never run on two threads at the same time.
+ * The thread calling handle() works as well, an executor with 1 thread starts no threads.
+ * Needs std::thread, on Arduino only available on the ESP32.
+ */
+class StateMachineExecutor {
+private:
+    struct Worker {
+        std::mutex m_lock;
+        std::vector<uint32_t> m_chunks;
+        size_t m_head;
+        size_t m_tail;
+    };
+
+    std::vector<StateMachine*> m_machines;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+    const size_t m_chunkSize;
+
+    std::mutex m_lock;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    uint32_t m_round;
+    size_t m_busy;
+    bool m_stop;
+    StateTime m_currentTime;
+
+    // Takes a chunk from the own queue or steals one from another worker
+    bool take(const size_t p_worker, uint32_t& p_chunk);
+    void work(const size_t p_worker);
+    void loop(const size_t p_worker);
+
+public:
+    StateMachineExecutor(const size_t p_threads, const size_t p_chunkSize = 256);
+
+    StateMachineExecutor(const StateMachineExecutor&) = delete;
+    StateMachineExecutor& operator=(const StateMachineExecutor&) = delete;
+
+    virtual ~StateMachineExecutor();
+
+    // Adds a machine, the executor does not own it. Don't call while handle() runs.
+    void add(StateMachine* p_machine);
+
+    // Number of machines
+    size_t size() const;
+
+    // Number of threads including the one calling handle()
+    size_t threads() const;
+
+    // Handles every machine once, returns when all machines are handled
+    void handle();
+
+    // Same as handle() with a time you already have
+    void handle(const StateTime p_currentTime);
+};
+
+#endif
@@ -0,0 +1,173 @@
+#include "statemachinegroup.hpp"
+
+#ifndef UNIT_TEST
+#include <Arduino.h>
+#else
+extern "C" uint32_t millis();
+#endif
+
+StateMachineGroup::StateMachineGroup() :
+    m_polling(0),
+    m_handling(false),
+    m_time(0) {
+}
+
+StateMachineGroup::StateMachineGroup(const size_t p_capacity) :
+    m_polling(0),
+    m_handling(false),
+    m_time(0) {
+    m_currentStates.reserve(p_capacity);
+    m_active.reserve(p_capacity);
+    m_nextActive.reserve(p_capacity);
+}
+
+StateMachineGroup::~StateMachineGroup() {
+}
+
+size_t StateMachineGroup::add(State* p_first) {
+    m_polling++;
+    m_active.push_back(m_currentStates.size());
+    m_sleeping.push_back(false);
+    m_currentStates.push_back(p_first);
+    return m_currentStates.size() - 1;
+}
+
+size_t StateMachineGroup::size() const {
+    return m_currentStates.size();
+}
+
+size_t StateMachineGroup::active() const {
+    return m_active.size();
+}
+
+void StateMachineGroup::start() {
+    start(MillisClock::now());
+}
+
+void StateMachineGroup::start(const StateTime p_currentTime) {
+    m_time = p_currentTime;
+    m_parked = TimerWheel(static_cast<uint32_t>(p_currentTime));
+
+    for (State* state : m_currentStates) {
+        State::enter(state, p_currentTime);
+    }
+}
+
+bool StateMachineGroup::current(const size_t p_machine, const State* state_id) const {
+    return m_currentStates[p_machine] == state_id;
+}
+
+void StateMachineGroup::handle() {
+    handle(MillisClock::now());
+}
+
+void StateMachineGroup::handle(const StateTime p_currentTime) {
+    // Machines whose time has passed are run again
+    m_time = p_currentTime;
+    m_parked.advance(static_cast<uint32_t>(p_currentTime), m_active);
+    m_nextActive.clear();
+    m_polling = 0;
+    m_handling = true;
+
+    for (const uint32_t machine : m_active) {
+        State* state = State::handle(m_currentStates[machine], p_currentTime);
+        m_currentStates[machine] = state;
+        StateTime deadline;
+
+        if (!state->deadline(p_currentTime, deadline)) {
+            // Without runnable nothing but an event can change this machine
+            if (state->m_run) {
+                m_nextActive.push_back(machine);
+            } else {
+                m_sleeping[machine] = true;
+            }
+        } else if (stateTimeDiff(deadline, p_currentTime) > 0) {
+            // A machine parked for longer than the wheel can hold is run early and parked again
+            const StateTime wait = deadline - p_currentTime;
+            m_parked.schedule(machine, static_cast<uint32_t>(p_currentTime + (wait > 0x7FFFFFFF ? 0x7FFFFFFF : wait)));
+        } else {
+            m_nextActive.push_back(machine);
+            m_polling++;
+        }
+    }
+
+    m_handling = false;
+    m_active.swap(m_nextActive);
+}
+
+bool StateMachineGroup::nextDeadline(StateTime& p_deadline) const {
+    return nextDeadline(MillisClock::now(), p_deadline);
+}
+
+bool StateMachineGroup::nextDeadline(const StateTime p_currentTime, StateTime& p_deadline) const {
+    if (m_polling > 0) {
+        p_deadline = p_currentTime;
+        return true;
+    }
+
+    uint32_t deadline;
+
+    if (!m_parked.nextDeadline(deadline)) {
+        return false;
+    }
+
+    p_deadline = m_time + (deadline - static_cast<uint32_t>(m_time));
+    return true;
+}
+
+void StateMachineGroup::wake(const uint32_t p_machine) {
+    if (m_sleeping[p_machine]) {
+        m_sleeping[p_machine] = false;
+    } else if (m_parked.scheduled(p_machine)) {
+        m_parked.cancel(p_machine);
+    } else {
+        // Already active
+        return;
+    }
+
+    // Handled on the next handle(), also when woken while handling
+    m_polling++;
+
+    if (m_handling) {
+        m_nextActive.push_back(p_machine);
+    } else {
+        m_active.push_back(p_machine);
+    }
+}
+
+void StateMachineGroup::dispatch(const size_t p_machine, const EventId p_event) {
+    dispatch(p_machine, p_event, MillisClock::now());
+}
+
+void StateMachineGroup::dispatch(const size_t p_machine, const EventId p_event, const StateTime p_currentTime) {
+    State* state = m_currentStates[p_machine];
+    State* newState = State::dispatch(state, p_event, p_currentTime);
+
+    if (state != newState) {
+        m_currentStates[p_machine] = newState;
+        wake(p_machine);
+    } else if (m_sleeping[p_machine] || m_parked.scheduled(p_machine)) {
+        // The state may have reacted without a transition and wait for something else now, like a coroutine
+        reschedule(p_machine, p_currentTime);
+    }
+}
+
+void StateMachineGroup::reschedule(const uint32_t p_machine, const StateTime p_currentTime) {
+    const State* state = m_currentStates[p_machine];
+    StateTime deadline;
+
+    if (!state->deadline(p_currentTime, deadline)) {
+        if (state->m_run) {
+            wake(p_machine);
+        } else if (m_parked.scheduled(p_machine)) {
+            m_parked.cancel(p_machine);
+            m_sleeping[p_machine] = true;
+        }
+    } else if (stateTimeDiff(deadline, p_currentTime) > 0) {
+        const StateTime wait = deadline - p_currentTime;
+        m_sleeping[p_machine] = false;
+        m_parked.schedule(p_machine, static_cast<uint32_t>(p_currentTime + (wait > 0x7FFFFFFF ? 0x7FFFFFFF : wait)));
+    } else {
+        wake(p_machine);
+    }
+}
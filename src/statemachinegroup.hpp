@@ -0,0 +1,80 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "statemachine.hpp"
+#include "timerwheel.hpp"
+
+/**
+ * Runs many state machines at once. The time is read once for each handle()
+ * and the current states of all machines are kept next to each other in memory.
+ * Machines waiting in a StateTimed are parked in a timer wheel and are not run
+ * until their time has passed. Machines in a state that can only change by an event,
+ * like a StateEvents without runnable, sleep until an event is dispatched to them.
+ * Like StateMachine the group does not own the states.
+ */
+class StateMachineGroup {
+private:
+    std::vector<State*> m_currentStates;
+    // Machines that are run on each handle()
+    std::vector<uint32_t> m_active;
+    std::vector<uint32_t> m_nextActive;
+    // Machines that wait for an event
+    std::vector<bool> m_sleeping;
+    // Active machines that are not in a StateIdle
+    size_t m_polling;
+    bool m_handling;
+
+    void wake(const uint32_t p_machine);
+    // Parks, sleeps or wakes a machine that is not active by the deadline of its current state
+    void reschedule(const uint32_t p_machine, const StateTime p_currentTime);
+    // Keeps the lower 32 bits of the time, waits longer than 2^31 are parked in steps
+    TimerWheel m_parked;
+    // Time of the last start() or handle()
+    StateTime m_time;
+
+public:
+    StateMachineGroup();
+    StateMachineGroup(const size_t p_capacity);
+
+    virtual ~StateMachineGroup();
+
+    // Adds a machine that starts at p_first, returns the index of the machine in this group
+    size_t add(State* p_first);
+
+    // Number of machines in this group
+    size_t size() const;
+
+    // Number of machines that are not parked
+    size_t active() const;
+
+    // Call start once after you added all machines but as aclose as possible
+    // to your loop function
+    void start();
+
+    // Same as start() with a time you already have
+    void start(const StateTime p_currentTime);
+
+    // Evaluates if the current state of the given machine is the given state
+    bool current(const size_t p_machine, const State* state_id) const;
+
+    // Call in your loop function regularly, handles all machines
+    void handle();
+
+    // Same as handle() with a time you already have
+    void handle(const StateTime p_currentTime);
+
+    // Sets p_deadline to the earliest time at which handle() could change the state of any machine and returns true.
+    // Returns false when all machines are in a StateIdle, see StateMachine::nextDeadline()
+    bool nextDeadline(StateTime& p_deadline) const;
+
+    // Same as nextDeadline() with a time you already have
+    bool nextDeadline(const StateTime p_currentTime, StateTime& p_deadline) const;
+
+    // Lets the current state of the given machine react to p_event, see StateEvents
+    // Can be called from runnables of other machines in this group
+    void dispatch(const size_t p_machine, const EventId p_event);
+
+    // Same as dispatch() with a time you already have
+    void dispatch(const size_t p_machine, const EventId p_event, const StateTime p_currentTime);
+};
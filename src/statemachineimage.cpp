@@ -0,0 +1,304 @@
+#include "statemachineimage.hpp"
+#include <string.h>
+#include <algorithm>
+
+const uint32_t StateMachineImage::MAGIC;
+const StateId StateMachineImage::NONE;
+
+StateMachineCallbacks::Callback& StateMachineCallbacks::callback(const char* p_name) {
+    for (Callback& callback : m_callbacks) {
+        if (callback.m_name == p_name) {
+            return callback;
+        }
+    }
+
+    m_callbacks.push_back(Callback{p_name, nullptr, nullptr});
+    return m_callbacks.back();
+}
+
+const StateMachineCallbacks::Callback* StateMachineCallbacks::find(const char* p_name) const {
+    for (const Callback& callback : m_callbacks) {
+        if (callback.m_name == p_name) {
+            return &callback;
+        }
+    }
+
+    return nullptr;
+}
+
+void StateMachineCallbacks::guard(const char* p_name, const TGuard& p_guard) {
+    callback(p_name).m_guard = p_guard;
+}
+
+void StateMachineCallbacks::action(const char* p_name, const TAction& p_action) {
+    callback(p_name).m_action = p_action;
+}
+
+namespace {
+
+template<typename T>
+void append(std::vector<uint8_t>& p_image, const T& p_value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&p_value);
+    p_image.insert(p_image.end(), bytes, bytes + sizeof(T));
+}
+
+// Index of p_name in p_names, added when missing, NONE for an empty name
+uint16_t intern(std::vector<std::string>& p_names, const std::string& p_name) {
+    if (p_name.empty()) {
+        return StateMachineImage::NONE;
+    }
+
+    for (size_t i = 0; i < p_names.size(); i++) {
+        if (p_names[i] == p_name) {
+            return i;
+        }
+    }
+
+    p_names.push_back(p_name);
+    return p_names.size() - 1;
+}
+
+}
+
+StateMachineImage::StateMachineImage() :
+    m_header(nullptr),
+    m_states(nullptr),
+    m_transitions(nullptr),
+    m_strings(nullptr) {
+}
+
+bool StateMachineImage::compile(const char* p_text, std::vector<uint8_t>& p_image, std::string* p_error) {
+    StateMachineDescription description;
+
+    if (!description.parse(p_text, p_error)) {
+        return false;
+    }
+
+    std::vector<std::string> callbacks;
+    std::vector<ImageState> imageStates;
+    std::vector<ImageTransition> imageTransitions;
+    std::string strings;
+
+    for (const StateMachineDescription::State& state : description.states()) {
+        ImageState imageState{state.m_timeout, static_cast<uint32_t>(strings.size()), state.m_timeoutTo,
+                              intern(callbacks, state.m_timeoutAction), static_cast<uint16_t>(imageTransitions.size()), 0};
+        strings.append(state.m_name.c_str(), state.m_name.size() + 1);
+
+        for (const StateMachineDescription::Transition& transition : state.m_transitions) {
+            imageTransitions.push_back(ImageTransition{transition.m_event, transition.m_to,
+                                                       intern(callbacks, transition.m_guard), intern(callbacks, transition.m_action)});
+        }
+
+        // Sorted by event so dispatching can stop early, transitions on one event keep their order
+        std::stable_sort(imageTransitions.begin() + imageState.m_first, imageTransitions.end(),
+        [](const ImageTransition & p_a, const ImageTransition & p_b) {
+            return p_a.m_event < p_b.m_event;
+        });
+        imageState.m_count = imageTransitions.size() - imageState.m_first;
+        imageStates.push_back(imageState);
+    }
+
+    if (imageTransitions.size() >= 0xFFFF || callbacks.size() >= NONE) {
+        if (p_error != nullptr) {
+            *p_error = "Too many transitions or callbacks";
+        }
+
+        return false;
+    }
+
+    std::vector<uint32_t> callbackNames;
+
+    for (const std::string& callback : callbacks) {
+        callbackNames.push_back(strings.size());
+        strings.append(callback.c_str(), callback.size() + 1);
+    }
+
+    const size_t stringsOffset = sizeof(Header) + imageStates.size() * sizeof(ImageState) +
+                                 imageTransitions.size() * sizeof(ImageTransition) + callbackNames.size() * sizeof(uint32_t);
+    const Header header{MAGIC, static_cast<uint16_t>(imageStates.size()), static_cast<uint16_t>(imageTransitions.size()),
+                        static_cast<uint16_t>(callbackNames.size()), description.initial(),
+                        static_cast<uint32_t>(stringsOffset), static_cast<uint32_t>(stringsOffset + strings.size())};
+
+    p_image.clear();
+    p_image.reserve(header.m_size);
+    append(p_image, header);
+
+    for (const ImageState& state : imageStates) {
+        append(p_image, state);
+    }
+
+    for (const ImageTransition& transition : imageTransitions) {
+        append(p_image, transition);
+    }
+
+    for (const uint32_t name : callbackNames) {
+        append(p_image, name);
+    }
+
+    p_image.insert(p_image.end(), strings.begin(), strings.end());
+    return true;
+}
+
+bool StateMachineImage::load(const void* p_data, const size_t p_size, const StateMachineCallbacks& p_callbacks, std::string* p_error) {
+    m_header = nullptr;
+    m_callbacks.clear();
+    std::string error;
+    const Header* header = static_cast<const Header*>(p_data);
+    const uint8_t* bytes = static_cast<const uint8_t*>(p_data);
+
+    if (reinterpret_cast<uintptr_t>(p_data) % 4 != 0 || p_size < sizeof(Header) || header->m_magic != MAGIC) {
+        error = "Not a state machine image or not 4 byte aligned";
+    } else if (header->m_size != p_size || header->m_strings >= p_size || bytes[p_size - 1] != '\0' ||
+               header->m_strings != sizeof(Header) + header->m_states * sizeof(ImageState) +
+               header->m_transitions * sizeof(ImageTransition) + header->m_callbacks * sizeof(uint32_t) ||
+               header->m_initial >= header->m_states) {
+        error = "Image is damaged";
+    }
+
+    const ImageState* states = reinterpret_cast<const ImageState*>(bytes + sizeof(Header));
+    const ImageTransition* transitions = reinterpret_cast<const ImageTransition*>(states + (error.empty() ? header->m_states : 0));
+    const uint32_t* callbackNames = reinterpret_cast<const uint32_t*>(transitions + (error.empty() ? header->m_transitions : 0));
+    const char* strings = error.empty() ? reinterpret_cast<const char*>(bytes + header->m_strings) : nullptr;
+    const uint32_t stringsSize = error.empty() ? p_size - header->m_strings : 0;
+
+    // Callback ids must be bound to a callback of the right kind
+    auto bound = [this](const uint16_t p_callback, const bool p_guard) {
+        return p_callback == NONE ||
+               (p_callback < m_callbacks.size() && (p_guard ? (bool)m_callbacks[p_callback].m_guard : (bool)m_callbacks[p_callback].m_action));
+    };
+
+    for (uint16_t i = 0; error.empty() && i < header->m_callbacks; i++) {
+        const StateMachineCallbacks::Callback* callback =
+            callbackNames[i] < stringsSize ? p_callbacks.find(strings + callbackNames[i]) : nullptr;
+
+        if (callback == nullptr) {
+            error = callbackNames[i] < stringsSize ? std::string("Callback '") + (strings + callbackNames[i]) + "' is not registered" : "Image is damaged";
+        } else {
+            m_callbacks.push_back(Binding{callback->m_guard, callback->m_action});
+        }
+    }
+
+    for (uint16_t i = 0; error.empty() && i < header->m_states; i++) {
+        const ImageState& state = states[i];
+
+        if (state.m_name >= stringsSize || state.m_first + state.m_count > header->m_transitions ||
+                (state.m_timeoutTo != NONE && state.m_timeoutTo >= header->m_states) || !bound(state.m_timeoutAction, false)) {
+            error = "Image is damaged";
+        }
+
+        // dispatch() stops at the first transition on a later event
+        for (uint16_t t = state.m_first + 1; error.empty() && t < state.m_first + state.m_count; t++) {
+            if (transitions[t].m_event < transitions[t - 1].m_event) {
+                error = "Transitions of a state are not sorted by event";
+            }
+        }
+    }
+
+    for (uint16_t i = 0; error.empty() && i < header->m_transitions; i++) {
+        const ImageTransition& transition = transitions[i];
+
+        if (transition.m_to >= header->m_states) {
+            error = "Image is damaged";
+        } else if (!bound(transition.m_guard, true) || !bound(transition.m_action, false)) {
+            error = "A guard or action is registered as the other kind";
+        }
+    }
+
+    if (!error.empty()) {
+        m_callbacks.clear();
+
+        if (p_error != nullptr) {
+            *p_error = error;
+        }
+
+        return false;
+    }
+
+    m_header = header;
+    m_states = states;
+    m_transitions = transitions;
+    m_strings = strings;
+    return true;
+}
+
+size_t StateMachineImage::size() const {
+    return m_header == nullptr ? 0 : m_header->m_states;
+}
+
+StateId StateMachineImage::id(const char* p_name) const {
+    for (StateId i = 0; i < size(); i++) {
+        if (strcmp(m_strings + m_states[i].m_name, p_name) == 0) {
+            return i;
+        }
+    }
+
+    return NONE;
+}
+
+const char* StateMachineImage::name(const StateId p_state) const {
+    return m_strings + m_states[p_state].m_name;
+}
+
+void StateMachineImage::start(StateMachineInstance& p_instance) const {
+    start(p_instance, MillisClock::now());
+}
+
+void StateMachineImage::start(StateMachineInstance& p_instance, const StateTime p_currentTime) const {
+    p_instance.m_state = m_header->m_initial;
+    p_instance.m_startTime = p_currentTime;
+}
+
+void StateMachineImage::enter(StateMachineInstance& p_instance, const StateId p_state, const uint16_t p_action, const StateTime p_currentTime) const {
+    if (p_action != NONE) {
+        m_callbacks[p_action].m_action(p_instance);
+    }
+
+    p_instance.m_state = p_state;
+    p_instance.m_startTime = p_currentTime;
+}
+
+void StateMachineImage::handle(StateMachineInstance& p_instance) const {
+    handle(p_instance, MillisClock::now());
+}
+
+void StateMachineImage::handle(StateMachineInstance& p_instance, const StateTime p_currentTime) const {
+    const ImageState& state = m_states[p_instance.m_state];
+
+    if (state.m_timeoutTo != NONE && p_currentTime - p_instance.m_startTime > state.m_timeout) {
+        enter(p_instance, state.m_timeoutTo, state.m_timeoutAction, p_currentTime);
+    }
+}
+
+bool StateMachineImage::dispatch(StateMachineInstance& p_instance, const EventId p_event) const {
+    return dispatch(p_instance, p_event, MillisClock::now());
+}
+
+bool StateMachineImage::dispatch(StateMachineInstance& p_instance, const EventId p_event, const StateTime p_currentTime) const {
+    const ImageState& state = m_states[p_instance.m_state];
+
+    for (uint16_t i = state.m_first; i < state.m_first + state.m_count; i++) {
+        const ImageTransition& transition = m_transitions[i];
+
+        if (transition.m_event > p_event) {
+            break;
+        }
+
+        if (transition.m_event == p_event && (transition.m_guard == NONE || m_callbacks[transition.m_guard].m_guard(p_instance))) {
+            enter(p_instance, transition.m_to, transition.m_action, p_currentTime);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool StateMachineImage::nextDeadline(const StateMachineInstance& p_instance, StateTime& p_deadline) const {
+    const ImageState& state = m_states[p_instance.m_state];
+
+    if (state.m_timeoutTo == NONE) {
+        return false;
+    }
+
+    p_deadline = p_instance.m_startTime + state.m_timeout + 1;
+    return true;
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "statemachine.hpp"
+#include "statemachinedefinition.hpp"
+#include "statemachinedescription.hpp"
+
+/**
+ * Guards and actions a StateMachineImage binds to by name when it is loaded.
+ * Like the runnables of a StateMachineDefinition they are shared by all instances and get the instance they run for.
+ */
+class StateMachineCallbacks {
+public:
+    typedef InplaceFunction<bool(const StateMachineInstance&)> TGuard;
+    typedef InplaceFunction<void(const StateMachineInstance&)> TAction;
+
+private:
+    friend class StateMachineImage;
+
+    struct Callback {
+        std::string m_name;
+        TGuard m_guard;
+        TAction m_action;
+    };
+
+    std::vector<Callback> m_callbacks;
+
+    Callback& callback(const char* p_name);
+    const Callback* find(const char* p_name) const;
+
+public:
+    // A guard allows a transition when it returns true
+    void guard(const char* p_name, const TGuard& p_guard);
+
+    // An action runs on a transition before the state changes
+    void action(const char* p_name, const TAction& p_action);
+};
+
+/**
+ * Machine graph loaded at runtime so the wiring can change without a recompile, for example per device model.
+ * compile() turns a JSON description, see StateMachineDescription, into a compact binary image once,
+ * on a host or at first boot.
+ * load() uses an image in place, so it can be memory mapped or stored in flash: it only checks the
+ * image and binds the callbacks by name, nothing is parsed or allocated per state.
+ * Machines are StateMachineInstance objects of 8 bytes like those of a StateMachineDefinition.
+ *
+ * A state may have a timeout, like StateTimed it takes its transition once the time has passed.
+ * Events are tried in the order they are listed, the first transition whose guard allows it is taken.
+ * Images are in the byte order of the machine that compiled them and must be 4 byte aligned.
+ */
+class StateMachineImage {
+public:
+    static const uint32_t MAGIC = 0x314D5353;
+    static const StateId NONE = 0xFFFF;
+
+private:
+    struct Header {
+        uint32_t m_magic;
+        uint16_t m_states;
+        uint16_t m_transitions;
+        uint16_t m_callbacks;
+        StateId m_initial;
+        uint32_t m_strings;
+        uint32_t m_size;
+    };
+
+    struct ImageState {
+        uint32_t m_timeout;
+        // Offset of the name in the strings
+        uint32_t m_name;
+        StateId m_timeoutTo;
+        uint16_t m_timeoutAction;
+        uint16_t m_first;
+        uint16_t m_count;
+    };
+
+    struct ImageTransition {
+        EventId m_event;
+        StateId m_to;
+        uint16_t m_guard;
+        uint16_t m_action;
+    };
+
+    struct Binding {
+        StateMachineCallbacks::TGuard m_guard;
+        StateMachineCallbacks::TAction m_action;
+    };
+
+    const Header* m_header;
+    const ImageState* m_states;
+    const ImageTransition* m_transitions;
+    const char* m_strings;
+    std::vector<Binding> m_callbacks;
+
+    void enter(StateMachineInstance& p_instance, const StateId p_state, const uint16_t p_action, const StateTime p_currentTime) const;
+
+public:
+    StateMachineImage();
+
+    // Compiles a JSON description to an image, returns false and sets p_error when the description is invalid
+    static bool compile(const char* p_text, std::vector<uint8_t>& p_image, std::string* p_error = nullptr);
+
+    // Uses the image at p_data, which must stay valid while this is used. Returns false and sets p_error
+    // when the image is damaged or a callback is not in p_callbacks.
+    bool load(const void* p_data, const size_t p_size, const StateMachineCallbacks& p_callbacks, std::string* p_error = nullptr);
+
+    // Number of states, 0 when nothing is loaded
+    size_t size() const;
+
+    // Id of the state named p_name or NONE
+    StateId id(const char* p_name) const;
+    const char* name(const StateId p_state) const;
+
+    // Puts p_instance in the initial state, call once for each instance before using it
+    void start(StateMachineInstance& p_instance) const;
+    void start(StateMachineInstance& p_instance, const StateTime p_currentTime) const;
+
+    // Takes the timeout of the current state of p_instance when it has passed
+    void handle(StateMachineInstance& p_instance) const;
+    void handle(StateMachineInstance& p_instance, const StateTime p_currentTime) const;
+
+    // Takes the first allowed transition on p_event, returns false when there is none
+    bool dispatch(StateMachineInstance& p_instance, const EventId p_event) const;
+    bool dispatch(StateMachineInstance& p_instance, const EventId p_event, const StateTime p_currentTime) const;
+
+    // Sets p_deadline to when the timeout of p_instance passes, returns false when its state has no timeout
+    bool nextDeadline(const StateMachineInstance& p_instance, StateTime& p_deadline) const;
+};
@@ -0,0 +1,71 @@
+#include "statemachinesimulation.hpp"
+
+StateMachineSimulation::StateMachineSimulation(StateMachineGroup& p_group, const StateTime p_start) :
+    m_group(p_group),
+    m_time(p_start),
+    m_sequence(0),
+    m_steps(0) {
+}
+
+void StateMachineSimulation::start() {
+    m_group.start(m_time);
+    step();
+}
+
+void StateMachineSimulation::schedule(const StateTime p_time, const size_t p_machine, const EventId p_event) {
+    m_events.push(ScheduledEvent{p_time, m_sequence++, p_machine, p_event});
+}
+
+void StateMachineSimulation::step() {
+    while (!m_events.empty() && stateTimeDiff(m_events.top().m_time, m_time) <= 0) {
+        const ScheduledEvent event = m_events.top();
+        m_events.pop();
+        m_group.dispatch(event.m_machine, event.m_event, m_time);
+    }
+
+    m_group.handle(m_time);
+    m_steps++;
+}
+
+void StateMachineSimulation::runUntil(const StateTime p_time) {
+    while (stateTimeDiff(p_time, m_time) > 0) {
+        StateTime next;
+        bool due = m_group.nextDeadline(m_time, next);
+
+        // Never handle twice at the same time, a polling machine moves one tick
+        if (due && stateTimeDiff(next, m_time) <= 0) {
+            next = m_time + 1;
+        }
+
+        if (!m_events.empty()) {
+            const StateTime event = stateTimeDiff(m_events.top().m_time, m_time) > 0 ? m_events.top().m_time : m_time + 1;
+
+            if (!due || stateTimeDiff(event, next) < 0) {
+                next = event;
+                due = true;
+            }
+        }
+
+        // Nothing changes before p_time
+        if (!due || stateTimeDiff(next, p_time) > 0) {
+            break;
+        }
+
+        m_time = next;
+        step();
+    }
+
+    m_time = p_time;
+}
+
+void StateMachineSimulation::runFor(const StateTime p_duration) {
+    runUntil(m_time + p_duration);
+}
+
+StateTime StateMachineSimulation::time() const {
+    return m_time;
+}
+
+uint64_t StateMachineSimulation::steps() const {
+    return m_steps;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <queue>
+#include <vector>
+#include "statemachinegroup.hpp"
+
+/**
+ * Runs a StateMachineGroup in virtual time for tests and simulations. Instead of handling the group on every tick
+ * the time jumps to the next StateTimed expiry or scheduled event, so days of time pass in a few handle() calls.
+ * While any machine is in a State that polls, time advances one tick per handle().
+ * Runs are deterministic, events at the same time are dispatched in the order they were scheduled.
+ * Runnables that need the time should use time() of the simulation, not millis().
+ *
+ * StateMachineGroup group;
+ * group.add(&first);
+ * StateMachineSimulation simulation{group};
+ * simulation.start();
+ * simulation.runFor(7UL * 24 * 3600 * 1000);
+ */
+class StateMachineSimulation {
+    struct ScheduledEvent {
+        StateTime m_time;
+        uint64_t m_sequence;
+        size_t m_machine;
+        EventId m_event;
+
+        // Order of the priority queue, earliest first
+        bool operator<(const ScheduledEvent& p_other) const {
+            if (m_time != p_other.m_time) {
+                return stateTimeDiff(m_time, p_other.m_time) > 0;
+            }
+
+            return m_sequence > p_other.m_sequence;
+        }
+    };
+
+    StateMachineGroup& m_group;
+    std::priority_queue<ScheduledEvent> m_events;
+    StateTime m_time;
+    uint64_t m_sequence;
+    uint64_t m_steps;
+
+    // Handles the group at the current time after dispatching all events that are due
+    void step();
+
+public:
+    StateMachineSimulation(StateMachineGroup& p_group, const StateTime p_start = 0);
+
+    // Starts the group at the start time and handles it once
+    void start();
+
+    // Dispatches p_event to p_machine at p_time, events in the past are dispatched on the next step
+    void schedule(const StateTime p_time, const size_t p_machine, const EventId p_event);
+
+    // Runs until p_time, afterwards the time of the simulation is p_time
+    void runUntil(const StateTime p_time);
+
+    void runFor(const StateTime p_duration);
+
+    // Current virtual time
+    StateTime time() const;
+
+    // Number of times the group was handled
+    uint64_t steps() const;
+};
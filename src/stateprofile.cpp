@@ -0,0 +1,70 @@
+#include "stateprofile.hpp"
+
+#if STATEMACHINE_PROFILE
+#include <stdio.h>
+#include <inttypes.h>
+
+static std::string stateName(const State* p_state, const size_t p_index) {
+    if (p_state->name() != nullptr) {
+        return p_state->name();
+    }
+
+    return "state" + std::to_string(p_index);
+}
+
+std::string profileTable(const std::vector<const State*>& p_states) {
+    char line[160];
+    snprintf(line, sizeof(line), "%-20s %10s %14s %12s %10s %14s\n",
+             "state", "entries", "dwell", "max dwell", "runs", "run us");
+    std::string table = line;
+
+    for (size_t i = 0; i < p_states.size(); i++) {
+        const StateProfile& profile = p_states[i]->profile();
+        snprintf(line, sizeof(line), "%-20s %10" PRIu32 " %14" PRIu64 " %12" PRIu64 " %10" PRIu32 " %14" PRIu64 "\n",
+                 stateName(p_states[i], i).c_str(),
+                 profile.m_entries,
+                 profile.m_dwellTime,
+                 (uint64_t)profile.m_maxDwellTime,
+                 profile.m_runs,
+                 profile.m_runTime);
+        table += line;
+    }
+
+    return table;
+}
+
+std::string profileJson(const std::vector<const State*>& p_states) {
+    std::string json = "[";
+
+    for (size_t i = 0; i < p_states.size(); i++) {
+        const StateProfile& profile = p_states[i]->profile();
+        json += i == 0 ? "{\"name\":\"" : ",{\"name\":\"";
+
+        for (const char c : stateName(p_states[i], i)) {
+            // Control characters are not allowed raw in JSON strings
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                json += escaped;
+                continue;
+            }
+
+            if (c == '"' || c == '\\') {
+                json += '\\';
+            }
+
+            json += c;
+        }
+
+        json += "\",\"entries\":" + std::to_string(profile.m_entries);
+        json += ",\"dwellTime\":" + std::to_string(profile.m_dwellTime);
+        json += ",\"maxDwellTime\":" + std::to_string(profile.m_maxDwellTime);
+        json += ",\"runs\":" + std::to_string(profile.m_runs);
+        json += ",\"runTime\":" + std::to_string(profile.m_runTime);
+        json += "}";
+    }
+
+    return json + "]";
+}
+
+#endif
@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "statemachine.hpp"
+
+#if STATEMACHINE_PROFILE
+
+/**
+ * Prints the profile of the given states as a text table, one line per state.
+ * States without name are named after their position in p_states.
+ */
+std::string profileTable(const std::vector<const State*>& p_states);
+
+/**
+ * Prints the profile of the given states as a JSON array with one object per state
+ */
+std::string profileJson(const std::vector<const State*>& p_states);
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+#include <stdint.h>
+#include "statemachineclock.hpp"
+
+/**
+ * When a state that is referred to by id runs, shared by StateMachineDefinition, IndexedStateMachine and the
+ * machines generated by statemachinegen so they all keep time like State, StateTimed and StateIdle do.
+ * The machine keeps the time the current state was entered.
+ */
+struct StateTiming {
+    enum Kind : uint8_t {
+        KIND_STATE,
+        KIND_TIMED,
+        KIND_IDLE
+    };
+
+    StateTime m_forTime;
+    Kind m_kind;
+
+    // Returns whether the runnable of a state entered at p_startTime runs at p_currentTime, other than timed states
+    // on every handle. A timed state runs the tick after its time passed and starts over in case it runs again.
+    bool due(StateTime& p_startTime, const StateTime p_currentTime) const {
+        if (m_kind == KIND_TIMED) {
+            if (p_currentTime - p_startTime <= m_forTime) {
+                return false;
+            }
+
+            p_startTime = p_currentTime;
+        }
+
+        return true;
+    }
+
+    // Same as State::deadline() for a state entered at p_startTime, p_runnable tells whether it has a runnable
+    bool deadline(const StateTime p_startTime, const StateTime p_currentTime, const bool p_runnable, StateTime& p_deadline) const {
+        switch (m_kind) {
+            case KIND_TIMED:
+                p_deadline = p_startTime + m_forTime + 1;
+                return true;
+
+            case KIND_IDLE:
+                return false;
+
+            default:
+                p_deadline = p_currentTime;
+                return p_runnable;
+        }
+    }
+};
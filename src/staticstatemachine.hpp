@@ -0,0 +1,320 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "statemachineclock.hpp"
+
+#ifndef UNIT_TEST
+#include <Arduino.h>
+#else
+extern "C" uint32_t millis();
+#endif
+
+/**
+ * Id of a state within a StaticStateMachine, this is the position of the state type
+ * in the list of states.
+ */
+typedef uint8_t StaticStateId;
+
+namespace statemachine_detail {
+
+template<typename T>
+struct AlwaysFalse {
+    static constexpr bool value = false;
+};
+
+template<typename T, typename... States>
+struct IndexOf;
+
+template<typename T>
+struct IndexOf<T> {
+    static_assert(AlwaysFalse<T>::value, "Type is not a state of this StaticStateMachine");
+    static constexpr StaticStateId value = 0;
+};
+
+template<typename T, typename... Rest>
+struct IndexOf<T, T, Rest...> {
+    static constexpr StaticStateId value = 0;
+};
+
+template<typename T, typename First, typename... Rest>
+struct IndexOf<T, First, Rest...> {
+    static constexpr StaticStateId value = 1 + IndexOf<T, Rest...>::value;
+};
+
+/**
+ * Unrolls into a chain of compares on the state id which the compiler turns into
+ * a switch, each state's run is called directly and can be inlined.
+ */
+template<size_t I, size_t N>
+struct StaticDispatch {
+    template<typename Tuple>
+    static inline StaticStateId run(Tuple& p_states, const StaticStateId p_id, const StateTime p_currentTime) {
+        return p_id == I ?
+               std::get<I>(p_states).run(p_currentTime) :
+               StaticDispatch < I + 1, N >::run(p_states, p_id, p_currentTime);
+    }
+};
+
+template<size_t N>
+struct StaticDispatch<N, N> {
+    template<typename Tuple>
+    static inline StaticStateId run(Tuple& p_states, const StaticStateId p_id, const StateTime p_currentTime) {
+        return p_id;
+    }
+};
+
+// Detects if a state type defines 'void transitionStart(const StateTime)' or 'void transitionEnd(const StateTime)'
+template<typename T>
+struct HasTransitionStart {
+    template<typename U>
+    static auto test(int) -> decltype(std::declval<U&>().transitionStart(StateTime()), std::true_type());
+    template<typename U>
+    static std::false_type test(...);
+    static constexpr bool value = decltype(test<T>(0))::value;
+};
+
+template<typename T>
+struct HasTransitionEnd {
+    template<typename U>
+    static auto test(int) -> decltype(std::declval<U&>().transitionEnd(StateTime()), std::true_type());
+    template<typename U>
+    static std::false_type test(...);
+    static constexpr bool value = decltype(test<T>(0))::value;
+};
+
+template<typename T>
+inline typename std::enable_if<HasTransitionStart<T>::value>::type transitionStart(T& p_state, const StateTime p_currentTime) {
+    p_state.transitionStart(p_currentTime);
+}
+
+template<typename T>
+inline typename std::enable_if < !HasTransitionStart<T>::value >::type transitionStart(T&, const StateTime) {
+}
+
+template<typename T>
+inline typename std::enable_if<HasTransitionEnd<T>::value>::type transitionEnd(T& p_state, const StateTime p_currentTime) {
+    p_state.transitionEnd(p_currentTime);
+}
+
+template<typename T>
+inline typename std::enable_if < !HasTransitionEnd<T>::value >::type transitionEnd(T&, const StateTime) {
+}
+
+template<typename... States>
+struct AnyTransitionStart {
+    static constexpr bool value = false;
+};
+
+template<typename First, typename... Rest>
+struct AnyTransitionStart<First, Rest...> {
+    static constexpr bool value = HasTransitionStart<First>::value || AnyTransitionStart<Rest...>::value;
+};
+
+template<typename... States>
+struct AnyTransitionEnd {
+    static constexpr bool value = false;
+};
+
+template<typename First, typename... Rest>
+struct AnyTransitionEnd<First, Rest...> {
+    static constexpr bool value = HasTransitionEnd<First>::value || AnyTransitionEnd<Rest...>::value;
+};
+
+/**
+ * Calls the transition hooks of the state with the given id, states without hooks compile to nothing
+ */
+template<size_t I, size_t N>
+struct StaticHooks {
+    template<typename Tuple>
+    static inline void start(Tuple& p_states, const StaticStateId p_id, const StateTime p_currentTime) {
+        if (p_id == I) {
+            transitionStart(std::get<I>(p_states), p_currentTime);
+        } else {
+            StaticHooks < I + 1, N >::start(p_states, p_id, p_currentTime);
+        }
+    }
+
+    template<typename Tuple>
+    static inline void end(Tuple& p_states, const StaticStateId p_id, const StateTime p_currentTime) {
+        if (p_id == I) {
+            transitionEnd(std::get<I>(p_states), p_currentTime);
+        } else {
+            StaticHooks < I + 1, N >::end(p_states, p_id, p_currentTime);
+        }
+    }
+};
+
+template<size_t N>
+struct StaticHooks<N, N> {
+    template<typename Tuple>
+    static inline void start(Tuple&, const StaticStateId, const StateTime) {
+    }
+
+    template<typename Tuple>
+    static inline void end(Tuple&, const StaticStateId, const StateTime) {
+    }
+};
+
+}
+
+/**
+ * Compile time list of states. Use it to get the id of a state from within a run function
+ * Lookup of the id does not need the state types to be complete, so states can refer to each other
+ *
+ * struct Off;
+ * struct On;
+ * typedef StaticStates<Off, On> Blink;
+ * struct Off {
+ *     StaticStateId run(const StateTime currentMillis) {
+ *         return Blink::id<On>();
+ *     }
+ * };
+ */
+template<typename... States>
+struct StaticStates {
+    static constexpr size_t size = sizeof...(States);
+
+    template<typename T>
+    static constexpr StaticStateId id() {
+        return statemachine_detail::IndexOf<T, States...>::value;
+    }
+};
+
+/**
+ * StateMachine where all states are known at compile time.
+ * Each state is a type with a 'StaticStateId run(const StateTime currentMillis)' function
+ * that returns the id of the next state. The first state in the list is the initial state.
+ * States may define 'void transitionStart(const StateTime)' and 'void transitionEnd(const StateTime)',
+ * they are called on a transition like the hooks of State. Machines without hooks don't check for them.
+ * Dispatching to the current state is done without virtual calls or std::function
+ */
+template<typename... States>
+class StaticStateMachine {
+    static_assert(sizeof...(States) > 0, "StaticStateMachine needs at least one state");
+    static_assert(sizeof...(States) <= 256, "StaticStateMachine supports up to 256 states");
+
+public:
+    typedef StaticStates<States...> List;
+
+private:
+    std::tuple<States...> m_states;
+    StaticStateId m_currentState;
+
+public:
+    StaticStateMachine() :
+        m_states(),
+        m_currentState(0) {
+    }
+
+    StaticStateMachine(const States& ... p_states) :
+        m_states(p_states...),
+        m_currentState(0) {
+    }
+
+    template<typename T>
+    static constexpr StaticStateId id() {
+        return List::template id<T>();
+    }
+
+    // Access a state object, for example to set it up before the machine starts
+    template<typename T>
+    T& state() {
+        return std::get<List::template id<T>()>(m_states);
+    }
+
+    // Call start once after you created the state machine but as aclose as possible
+    // to your loop function
+    void start() {
+        start(MillisClock::now());
+    }
+
+    // Same as start() with a time you already have
+    void start(const StateTime p_currentTime) {
+        m_currentState = 0;
+
+        if (statemachine_detail::AnyTransitionStart<States...>::value) {
+            statemachine_detail::StaticHooks<0, sizeof...(States)>::start(m_states, m_currentState, p_currentTime);
+        }
+    }
+
+    // Evaluates if the current state is the given state
+    bool current(const StaticStateId p_id) const {
+        return m_currentState == p_id;
+    }
+
+    template<typename T>
+    bool current() const {
+        return m_currentState == List::template id<T>();
+    }
+
+    // Call in your loop function regularly
+    void handle() {
+        handle(MillisClock::now());
+    }
+
+    void handle(const StateTime p_currentTime) {
+        const StaticStateId next = statemachine_detail::StaticDispatch<0, sizeof...(States)>::run(m_states, m_currentState, p_currentTime);
+
+        if (next != m_currentState) {
+            if (statemachine_detail::AnyTransitionEnd<States...>::value) {
+                statemachine_detail::StaticHooks<0, sizeof...(States)>::end(m_states, m_currentState, p_currentTime);
+            }
+
+            if (statemachine_detail::AnyTransitionStart<States...>::value) {
+                statemachine_detail::StaticHooks<0, sizeof...(States)>::start(m_states, next, p_currentTime);
+            }
+
+            m_currentState = next;
+        }
+    }
+};
+
+/**
+ * Allows to pass a previously declared list of states, eg StaticStateMachine<Blink>
+ */
+template<typename... States>
+class StaticStateMachine<StaticStates<States...>> : public StaticStateMachine<States...> {
+public:
+    using StaticStateMachine<States...>::StaticStateMachine;
+};
+
+/**
+ * Base for a static state that runs once the given time has passed, the same as StateTimed.
+ * Derived is the state itself and List the StaticStates it is part of, Derived implements
+ * 'StaticStateId expired(const StateTime currentMillis)' which is called when the time has passed.
+ *
+ * struct Off : StaticStateTimed<Off, Blink> {
+ *     Off() : StaticStateTimed(500) {}
+ *     StaticStateId expired(const StateTime currentMillis) {
+ *         return Blink::id<On>();
+ *     }
+ * };
+ */
+template<typename Derived, typename List>
+class StaticStateTimed {
+    StateTime m_forTime;
+    StateTime m_startTime;
+
+public:
+    StaticStateTimed(const StateTime p_forTime) :
+        m_forTime(p_forTime),
+        m_startTime(0) {
+    }
+
+    void transitionStart(const StateTime p_currentTime) {
+        m_startTime = p_currentTime;
+    }
+
+    StaticStateId run(const StateTime p_currentTime) {
+        if (p_currentTime - m_startTime > m_forTime) {
+            // We reset the time in case we re-run this state again
+            m_startTime = p_currentTime;
+            return static_cast<Derived*>(this)->expired(p_currentTime);
+        }
+
+        return List::template id<Derived>();
+    }
+};
@@ -0,0 +1,322 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "statemachine.hpp"
+#include "staticstatemachine.hpp"
+
+namespace statemachine_detail {
+
+struct StaticEntry {
+    StaticStateId m_from;
+    EventId m_event;
+    StaticStateId m_to;
+    // Marks m_from as a state that needs no exit, it is not a transition
+    bool m_final;
+};
+
+// Set of state ids that can be used in constant expressions
+struct StaticStateSet {
+    uint64_t m_words[4];
+
+    constexpr bool has(const StaticStateId p_id) const {
+        return ((m_words[p_id / 64] >> (p_id % 64)) & 1) != 0;
+    }
+
+    constexpr uint64_t word(const size_t p_word, const StaticStateId p_id) const {
+        return p_id / 64 == p_word ? m_words[p_word] | (1ULL << (p_id % 64)) : m_words[p_word];
+    }
+
+    constexpr StaticStateSet with(const StaticStateId p_id) const {
+        return StaticStateSet{{word(0, p_id), word(1, p_id), word(2, p_id), word(3, p_id)}};
+    }
+
+    constexpr StaticStateSet join(const StaticStateSet& p_other) const {
+        return StaticStateSet{{m_words[0] | p_other.m_words[0], m_words[1] | p_other.m_words[1],
+                               m_words[2] | p_other.m_words[2], m_words[3] | p_other.m_words[3]}};
+    }
+
+    constexpr bool equals(const StaticStateSet& p_other) const {
+        return m_words[0] == p_other.m_words[0] && m_words[1] == p_other.m_words[1] &&
+               m_words[2] == p_other.m_words[2] && m_words[3] == p_other.m_words[3];
+    }
+};
+
+/*
+ * C++11 constexpr functions are a single return, so the checks recurse. They split ranges in halves
+ * to keep the recursion depth logarithmic in the number of transitions.
+ */
+
+constexpr bool staticStatesValid(const StaticEntry* p_entries, const size_t p_begin, const size_t p_end, const size_t p_states) {
+    return p_end - p_begin == 1 ?
+           p_entries[p_begin].m_from < p_states && p_entries[p_begin].m_to < p_states :
+           staticStatesValid(p_entries, p_begin, (p_begin + p_end) / 2, p_states) &&
+           staticStatesValid(p_entries, (p_begin + p_end) / 2, p_end, p_states);
+}
+
+// True when no transition in the range has the state and event of p_entry
+constexpr bool staticNoTransition(const StaticEntry* p_entries, const size_t p_begin, const size_t p_end, const StaticEntry& p_entry) {
+    return p_end <= p_begin ? true :
+           p_end - p_begin == 1 ?
+           p_entries[p_begin].m_final || p_entry.m_final ||
+           p_entries[p_begin].m_from != p_entry.m_from || p_entries[p_begin].m_event != p_entry.m_event :
+           staticNoTransition(p_entries, p_begin, (p_begin + p_end) / 2, p_entry) &&
+           staticNoTransition(p_entries, (p_begin + p_end) / 2, p_end, p_entry);
+}
+
+constexpr bool staticUnique(const StaticEntry* p_entries, const size_t p_begin, const size_t p_end, const size_t p_size) {
+    return p_end - p_begin == 1 ?
+           staticNoTransition(p_entries, p_begin + 1, p_size, p_entries[p_begin]) :
+           staticUnique(p_entries, p_begin, (p_begin + p_end) / 2, p_size) &&
+           staticUnique(p_entries, (p_begin + p_end) / 2, p_end, p_size);
+}
+
+// States reached with one transition from p_from
+constexpr StaticStateSet staticSuccessors(const StaticEntry* p_entries, const size_t p_begin, const size_t p_end, const StaticStateSet& p_from) {
+    return p_end - p_begin == 1 ?
+           (!p_entries[p_begin].m_final && p_from.has(p_entries[p_begin].m_from) ?
+            StaticStateSet{{0, 0, 0, 0}}.with(p_entries[p_begin].m_to) : StaticStateSet{{0, 0, 0, 0}}) :
+           staticSuccessors(p_entries, p_begin, (p_begin + p_end) / 2, p_from).join(
+               staticSuccessors(p_entries, (p_begin + p_end) / 2, p_end, p_from));
+}
+
+// All states reachable from p_from, recurses once per step away from p_from
+constexpr StaticStateSet staticClosure(const StaticEntry* p_entries, const size_t p_size, const StaticStateSet& p_from) {
+    return p_from.join(staticSuccessors(p_entries, 0, p_size, p_from)).equals(p_from) ?
+           p_from :
+           staticClosure(p_entries, p_size, p_from.join(staticSuccessors(p_entries, 0, p_size, p_from)));
+}
+
+constexpr bool staticAllIn(const StaticStateSet& p_set, const size_t p_begin, const size_t p_end) {
+    return p_end - p_begin == 1 ?
+           p_set.has(p_begin) :
+           staticAllIn(p_set, p_begin, (p_begin + p_end) / 2) && staticAllIn(p_set, (p_begin + p_end) / 2, p_end);
+}
+
+// True when p_state is final or has a transition to another state
+constexpr bool staticHasExit(const StaticEntry* p_entries, const size_t p_begin, const size_t p_end, const StaticStateId p_state) {
+    return p_end - p_begin == 1 ?
+           p_entries[p_begin].m_from == p_state && (p_entries[p_begin].m_final || p_entries[p_begin].m_to != p_state) :
+           staticHasExit(p_entries, p_begin, (p_begin + p_end) / 2, p_state) ||
+           staticHasExit(p_entries, (p_begin + p_end) / 2, p_end, p_state);
+}
+
+constexpr bool staticAllExit(const StaticEntry* p_entries, const size_t p_size, const size_t p_begin, const size_t p_end) {
+    return p_end - p_begin == 1 ?
+           staticHasExit(p_entries, 0, p_size, p_begin) :
+           staticAllExit(p_entries, p_size, p_begin, (p_begin + p_end) / 2) &&
+           staticAllExit(p_entries, p_size, (p_begin + p_end) / 2, p_end);
+}
+
+constexpr EventId staticEvents(const StaticEntry* p_entries, const size_t p_begin, const size_t p_end) {
+    return p_end - p_begin == 1 ?
+           (p_entries[p_begin].m_final ? 0 : p_entries[p_begin].m_event + 1) :
+           staticEvents(p_entries, p_begin, (p_begin + p_end) / 2) > staticEvents(p_entries, (p_begin + p_end) / 2, p_end) ?
+           staticEvents(p_entries, p_begin, (p_begin + p_end) / 2) : staticEvents(p_entries, (p_begin + p_end) / 2, p_end);
+}
+
+// Target of the transition for p_state and p_event, 0xFFFF when there is none
+constexpr uint16_t staticTarget(const StaticEntry* p_entries, const size_t p_begin, const size_t p_end, const StaticStateId p_state, const EventId p_event) {
+    return p_end - p_begin == 1 ?
+           (!p_entries[p_begin].m_final && p_entries[p_begin].m_from == p_state && p_entries[p_begin].m_event == p_event ?
+            p_entries[p_begin].m_to : 0xFFFF) :
+           staticTarget(p_entries, p_begin, (p_begin + p_end) / 2, p_state, p_event) != 0xFFFF ?
+           staticTarget(p_entries, p_begin, (p_begin + p_end) / 2, p_state, p_event) :
+           staticTarget(p_entries, (p_begin + p_end) / 2, p_end, p_state, p_event);
+}
+
+template<size_t... I>
+struct IndexSequence {
+};
+
+template<typename A, typename B>
+struct ConcatIndices;
+
+template<size_t... A, size_t... B>
+struct ConcatIndices<IndexSequence<A...>, IndexSequence<B...>> {
+    typedef IndexSequence < A..., (sizeof...(A) + B)... > type;
+};
+
+// IndexSequence<0, ..., N - 1> with a template depth logarithmic in N
+template<size_t N>
+struct MakeIndices {
+    typedef typename ConcatIndices < typename MakeIndices < N / 2 >::type, typename MakeIndices < N - N / 2 >::type >::type type;
+};
+
+template<>
+struct MakeIndices<0> {
+    typedef IndexSequence<> type;
+};
+
+template<>
+struct MakeIndices<1> {
+    typedef IndexSequence<0> type;
+};
+
+/**
+ * Next state for every state and event, computed by the compiler
+ */
+template<typename Table, typename Indices>
+struct StaticNextStates;
+
+template<typename Table, size_t... I>
+struct StaticNextStates<Table, IndexSequence<I...>> {
+    static constexpr StaticStateId values[sizeof...(I)] = {Table::next(I / Table::events, I % Table::events)...};
+};
+
+template<typename Table, size_t... I>
+constexpr StaticStateId StaticNextStates<Table, IndexSequence<I...>>::values[sizeof...(I)];
+
+}
+
+/**
+ * Transition from state From to state To on event Event in a StaticTransitionTable
+ */
+template<StaticStateId From, EventId Event, StaticStateId To>
+struct StaticOn {
+    static constexpr statemachine_detail::StaticEntry entry() {
+        return statemachine_detail::StaticEntry{From, Event, To, false};
+    }
+};
+
+/**
+ * Marks State as a state the machine is allowed to stay in forever
+ */
+template<StaticStateId State>
+struct StaticFinal {
+    static constexpr statemachine_detail::StaticEntry entry() {
+        return statemachine_detail::StaticEntry{State, 0, State, true};
+    }
+};
+
+/**
+ * Transitions known at compile time, states are the ids 0 up to States - 1.
+ * The table only holds the transitions and answers questions about them in constant expressions,
+ * StaticTransitionMachine checks them with static_assert and dispatches events through the table.
+ *
+ * enum : StaticStateId { IDLE, RUNNING, BROKEN, STATES };
+ * enum : EventId { START, STOP, FAULT };
+ * typedef StaticTransitionTable<STATES, IDLE,
+ *         StaticOn<IDLE, START, RUNNING>,
+ *         StaticOn<RUNNING, STOP, IDLE>,
+ *         StaticOn<RUNNING, FAULT, BROKEN>,
+ *         StaticFinal<BROKEN>> Motor;
+ */
+template<size_t States, StaticStateId Initial, typename... Entries>
+class StaticTransitionTable {
+    static_assert(States > 0 && States <= 256, "StaticTransitionTable supports 1 up to 256 states");
+    static_assert(sizeof...(Entries) > 0, "StaticTransitionTable needs at least one transition or StaticFinal");
+
+public:
+    static constexpr size_t states = States;
+    static constexpr StaticStateId initial = Initial;
+    static constexpr size_t size = sizeof...(Entries);
+    static constexpr statemachine_detail::StaticEntry entries[sizeof...(Entries)] = {Entries::entry()...};
+    // Highest event id + 1, at least 1
+    static constexpr EventId events = statemachine_detail::staticEvents(entries, 0, size) > 0 ?
+                                      statemachine_detail::staticEvents(entries, 0, size) : 1;
+
+    // All transitions are between states below States
+    static constexpr bool validStates() {
+        return Initial < States && statemachine_detail::staticStatesValid(entries, 0, size, States);
+    }
+
+    // No state has two transitions for the same event
+    static constexpr bool unique() {
+        return statemachine_detail::staticUnique(entries, 0, size, size);
+    }
+
+    // p_state can be reached from the initial state
+    static constexpr bool reachable(const StaticStateId p_state) {
+        return statemachine_detail::staticClosure(entries, size, statemachine_detail::StaticStateSet{{0, 0, 0, 0}}.with(Initial)).has(p_state);
+    }
+
+    static constexpr bool allReachable() {
+        return statemachine_detail::staticAllIn(
+                   statemachine_detail::staticClosure(entries, size, statemachine_detail::StaticStateSet{{0, 0, 0, 0}}.with(Initial)), 0, States);
+    }
+
+    // p_state is final or has a transition to another state
+    static constexpr bool hasExit(const StaticStateId p_state) {
+        return statemachine_detail::staticHasExit(entries, 0, size, p_state);
+    }
+
+    static constexpr bool allExit() {
+        return statemachine_detail::staticAllExit(entries, size, 0, States);
+    }
+
+    // State after p_event in p_state, p_state when it does not react to p_event
+    static constexpr StaticStateId next(const StaticStateId p_state, const EventId p_event) {
+        return statemachine_detail::staticTarget(entries, 0, size, p_state, p_event) == 0xFFFF ?
+               p_state : statemachine_detail::staticTarget(entries, 0, size, p_state, p_event);
+    }
+};
+
+template<size_t States, StaticStateId Initial, typename... Entries>
+constexpr size_t StaticTransitionTable<States, Initial, Entries...>::states;
+
+template<size_t States, StaticStateId Initial, typename... Entries>
+constexpr StaticStateId StaticTransitionTable<States, Initial, Entries...>::initial;
+
+template<size_t States, StaticStateId Initial, typename... Entries>
+constexpr size_t StaticTransitionTable<States, Initial, Entries...>::size;
+
+template<size_t States, StaticStateId Initial, typename... Entries>
+constexpr statemachine_detail::StaticEntry StaticTransitionTable<States, Initial, Entries...>::entries[sizeof...(Entries)];
+
+template<size_t States, StaticStateId Initial, typename... Entries>
+constexpr EventId StaticTransitionTable<States, Initial, Entries...>::events;
+
+/**
+ * Event driven machine on a StaticTransitionTable. The table is checked when the machine is compiled:
+ * every state is reachable from the initial state, every state has a way out unless it is StaticFinal,
+ * no transition points to a state that does not exist and no state has two transitions for one event.
+ * Dispatching is one lookup in a state x event array the compiler builds from the table, so the
+ * table is meant for machines of tens of states and events.
+ *
+ * StaticTransitionMachine<Motor> motor;
+ * motor.dispatch(START);
+ * motor.current(RUNNING);
+ */
+template<typename Table>
+class StaticTransitionMachine {
+    static_assert(Table::validStates(), "A transition or the initial state uses a state id that is not below the number of states");
+    static_assert(Table::unique(), "A state has two transitions for the same event");
+    static_assert(Table::allReachable(), "A state can not be reached from the initial state");
+    static_assert(Table::allExit(), "A state has no transition to another state, add StaticFinal when that is intended");
+
+    typedef statemachine_detail::StaticNextStates < Table,
+            typename statemachine_detail::MakeIndices < Table::states* Table::events >::type > Next;
+
+    StaticStateId m_currentState;
+
+public:
+    StaticTransitionMachine() :
+        m_currentState(Table::initial) {
+    }
+
+    // Goes back to the initial state
+    void start() {
+        m_currentState = Table::initial;
+    }
+
+    StaticStateId state() const {
+        return m_currentState;
+    }
+
+    // Evaluates if the current state is the given state
+    bool current(const StaticStateId p_id) const {
+        return m_currentState == p_id;
+    }
+
+    // Takes the transition for p_event, returns false when the current state does not react to it
+    bool dispatch(const EventId p_event) {
+        if (p_event >= Table::events) {
+            return false;
+        }
+
+        const StaticStateId next = Next::values[m_currentState * Table::events + p_event];
+        const bool transitioned = next != m_currentState;
+        m_currentState = next;
+        return transitioned;
+    }
+};
@@ -0,0 +1,231 @@
+#include "timerwheel.hpp"
+
+const uint32_t TimerWheel::NONE;
+const uint8_t TimerWheel::LEVEL_BITS;
+const uint8_t TimerWheel::SLOTS;
+const uint8_t TimerWheel::LEVELS;
+const uint32_t TimerWheel::RANGE;
+const uint16_t TimerWheel::NO_BUCKET;
+
+TimerWheel::TimerWheel(const uint32_t p_time) :
+    m_time(p_time),
+    m_count(0) {
+    for (uint32_t& head : m_heads) {
+        head = NONE;
+    }
+
+    for (uint64_t& occupied : m_occupied) {
+        occupied = 0;
+    }
+}
+
+void TimerWheel::insert(const uint32_t p_entry) {
+    Entry& entry = m_entries[p_entry];
+    uint32_t delta = entry.m_deadline - m_time;
+    uint32_t place = entry.m_deadline;
+
+    if (delta == 0 || delta >= 0x80000000UL) {
+        // Already due, expires on the next tick
+        delta = 1;
+        place = m_time + 1;
+    } else if (delta >= RANGE) {
+        // Park in the last slot of the top level, it's re-inserted once that slot is reached. A parked entry expires
+        // after its slot so slot order is only deadline order for entries that aren't parked, see nextDeadline()
+        delta = RANGE - 1;
+        place = m_time + RANGE - 1;
+    }
+
+    uint8_t level = 0;
+
+    while (level < LEVELS - 1 && delta >= (1UL << (LEVEL_BITS * (level + 1)))) {
+        level++;
+    }
+
+    const uint8_t slot = (place >> (LEVEL_BITS * level)) & (SLOTS - 1);
+    const uint16_t bucket = level * SLOTS + slot;
+    entry.m_bucket = bucket;
+    entry.m_prev = NONE;
+    entry.m_next = m_heads[bucket];
+
+    if (entry.m_next != NONE) {
+        m_entries[entry.m_next].m_prev = p_entry;
+    }
+
+    m_heads[bucket] = p_entry;
+    m_occupied[level] |= 1ULL << slot;
+    m_count++;
+}
+
+void TimerWheel::unlink(const uint32_t p_entry) {
+    Entry& entry = m_entries[p_entry];
+    const uint16_t bucket = entry.m_bucket;
+
+    if (entry.m_prev != NONE) {
+        m_entries[entry.m_prev].m_next = entry.m_next;
+    } else {
+        m_heads[bucket] = entry.m_next;
+    }
+
+    if (entry.m_next != NONE) {
+        m_entries[entry.m_next].m_prev = entry.m_prev;
+    }
+
+    if (m_heads[bucket] == NONE) {
+        m_occupied[bucket / SLOTS] &= ~(1ULL << (bucket % SLOTS));
+    }
+
+    entry.m_bucket = NO_BUCKET;
+    m_count--;
+}
+
+uint32_t TimerWheel::nextAt(const uint8_t p_level) const {
+    const uint64_t occupied = m_occupied[p_level];
+
+    if (occupied == 0) {
+        return 0;
+    }
+
+    // Rotate the slots so the slot after the current one is at bit 0
+    const uint32_t current = m_time >> (LEVEL_BITS * p_level);
+    const uint8_t shift = (current + 1) & (SLOTS - 1);
+    const uint64_t rotated = shift == 0 ? occupied : (occupied >> shift) | (occupied << (SLOTS - shift));
+    const uint32_t distance = __builtin_ctzll(rotated) + 1;
+    return ((current + distance) << (LEVEL_BITS * p_level)) - m_time;
+}
+
+void TimerWheel::schedule(const uint32_t p_entry, const uint32_t p_deadline) {
+    if (p_entry >= m_entries.size()) {
+        m_entries.resize(p_entry + 1, Entry{NONE, NONE, 0, NO_BUCKET});
+    } else if (m_entries[p_entry].m_bucket != NO_BUCKET) {
+        unlink(p_entry);
+    }
+
+    m_entries[p_entry].m_deadline = p_deadline;
+    insert(p_entry);
+}
+
+void TimerWheel::cancel(const uint32_t p_entry) {
+    if (scheduled(p_entry)) {
+        unlink(p_entry);
+    }
+}
+
+bool TimerWheel::scheduled(const uint32_t p_entry) const {
+    return p_entry < m_entries.size() && m_entries[p_entry].m_bucket != NO_BUCKET;
+}
+
+size_t TimerWheel::size() const {
+    return m_count;
+}
+
+uint32_t TimerWheel::time() const {
+    return m_time;
+}
+
+bool TimerWheel::nextDeadline(uint32_t& p_deadline) const {
+    if (m_count == 0) {
+        return false;
+    }
+
+    // Entries at level 0 expire exactly when their slot is reached
+    uint32_t next = nextAt(0);
+
+    // Higher levels hold a range of deadlines per slot, in slot order except for parked entries, which expire after
+    // their slot. The first slot with an entry that isn't parked ends the search at a level.
+    for (uint8_t level = 1; level < LEVELS; level++) {
+        const uint32_t current = m_time >> (LEVEL_BITS * level);
+        const uint8_t shift = (current + 1) & (SLOTS - 1);
+        const uint64_t occupied = m_occupied[level];
+        uint64_t rotated = shift == 0 ? occupied : (occupied >> shift) | (occupied << (SLOTS - shift));
+
+        while (rotated != 0) {
+            const uint32_t slot = current + __builtin_ctzll(rotated) + 1;
+            const uint32_t at = (slot << (LEVEL_BITS * level)) - m_time;
+            const uint32_t end = at + (1UL << (LEVEL_BITS * level));
+
+            if (next != 0 && at >= next) {
+                break;
+            }
+
+            bool parked = true;
+
+            for (uint32_t entry = m_heads[level * SLOTS + (slot & (SLOTS - 1))]; entry != NONE; entry = m_entries[entry].m_next) {
+                const uint32_t distance = m_entries[entry].m_deadline - m_time;
+
+                if (next == 0 || distance < next) {
+                    next = distance;
+                }
+
+                parked = parked && distance >= end;
+            }
+
+            if (!parked) {
+                break;
+            }
+
+            rotated &= rotated - 1;
+        }
+    }
+
+    p_deadline = m_time + next;
+    return true;
+}
+
+void TimerWheel::advance(const uint32_t p_time, std::vector<uint32_t>& p_expired) {
+    const uint32_t remaining = p_time - m_time;
+
+    // Time never goes back
+    if (remaining >= 0x80000000UL) {
+        return;
+    }
+
+    const uint32_t end = p_time;
+
+    while (m_count > 0) {
+        uint32_t next = 0;
+
+        for (uint8_t level = 0; level < LEVELS; level++) {
+            const uint32_t at = nextAt(level);
+
+            if (at != 0 && (next == 0 || at < next)) {
+                next = at;
+            }
+        }
+
+        if (next > end - m_time) {
+            break;
+        }
+
+        m_time += next;
+
+        // Move entries from higher levels down now their slot is reached
+        for (uint8_t level = LEVELS - 1; level > 0; level--) {
+            if ((m_time & ((1UL << (LEVEL_BITS * level)) - 1)) != 0) {
+                continue;
+            }
+
+            const uint16_t bucket = level * SLOTS + ((m_time >> (LEVEL_BITS * level)) & (SLOTS - 1));
+
+            while (m_heads[bucket] != NONE) {
+                const uint32_t entry = m_heads[bucket];
+                unlink(entry);
+
+                if (m_entries[entry].m_deadline == m_time) {
+                    p_expired.push_back(entry);
+                } else {
+                    insert(entry);
+                }
+            }
+        }
+
+        const uint16_t bucket = m_time & (SLOTS - 1);
+
+        while (m_heads[bucket] != NONE) {
+            const uint32_t entry = m_heads[bucket];
+            unlink(entry);
+            p_expired.push_back(entry);
+        }
+    }
+
+    m_time = end;
+}
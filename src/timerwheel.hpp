@@ -0,0 +1,65 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/**
+ * Hierarchical timer wheel for entries identified by a number, for example the index of
+ * a machine in a StateMachineGroup.
+ * Four levels of 64 slots cover 2^24 ticks, entries further away are re-inserted when the
+ * top level wraps around. Advancing only touches slots that hold entries so the cost
+ * depends on the number of expiring entries, not on the number of waiting entries.
+ */
+class TimerWheel {
+public:
+    static const uint32_t NONE = 0xFFFFFFFF;
+
+private:
+    static const uint8_t LEVEL_BITS = 6;
+    static const uint8_t SLOTS = 1 << LEVEL_BITS;
+    static const uint8_t LEVELS = 4;
+    static const uint32_t RANGE = 1UL << (LEVEL_BITS * LEVELS);
+    static const uint16_t NO_BUCKET = 0xFFFF;
+
+    struct Entry {
+        uint32_t m_next;
+        uint32_t m_prev;
+        uint32_t m_deadline;
+        uint16_t m_bucket;
+    };
+
+    std::vector<Entry> m_entries;
+    uint32_t m_heads[LEVELS * SLOTS];
+    uint64_t m_occupied[LEVELS];
+    uint32_t m_time;
+    size_t m_count;
+
+    // Puts p_entry in the slot of its deadline, or parks it in the last slot of the top level when it's too far away
+    void insert(const uint32_t p_entry);
+    void unlink(const uint32_t p_entry);
+    // Distance from m_time to the next time something needs to be done at level p_level, 0 when nothing
+    uint32_t nextAt(const uint8_t p_level) const;
+
+public:
+    TimerWheel(const uint32_t p_time = 0);
+
+    // Schedules p_entry to expire at p_deadline, deadlines at or before the current time expire on the next advance
+    void schedule(const uint32_t p_entry, const uint32_t p_deadline);
+
+    // Removes p_entry from the wheel when it is scheduled
+    void cancel(const uint32_t p_entry);
+
+    bool scheduled(const uint32_t p_entry) const;
+
+    // Number of scheduled entries
+    size_t size() const;
+
+    // Current time of the wheel
+    uint32_t time() const;
+
+    // Sets p_deadline to the earliest time at which an entry expires, returns false when the wheel is empty
+    bool nextDeadline(uint32_t& p_deadline) const;
+
+    // Moves the time forward to p_time and appends all entries that expired to p_expired
+    void advance(const uint32_t p_time, std::vector<uint32_t>& p_expired);
+};
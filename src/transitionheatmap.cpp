@@ -0,0 +1,211 @@
+#include "transitionheatmap.hpp"
+#include <stdio.h>
+#include <algorithm>
+#include <new>
+#include "statemachine.hpp"
+
+const size_t TransitionHeatMap::CACHE_LINE;
+
+static size_t roundUpToPowerOfTwo(const size_t p_value) {
+    size_t value = 1;
+
+    while (value < p_value) {
+        value <<= 1;
+    }
+
+    return value;
+}
+
+// Index of the calling thread, threads get the next index the first time they ask
+static size_t threadIndex() {
+    static std::atomic<size_t> next{0};
+    thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+TransitionHeatMap::TransitionHeatMap(const size_t p_edges, const size_t p_shards) :
+    m_shards(p_shards == 0 ? 1 : p_shards),
+    m_mask(roundUpToPowerOfTwo(p_edges) - 1),
+    m_stride(CACHE_LINE + ((m_mask + 1) * sizeof(Slot) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE),
+    m_buffer(new uint8_t[m_shards * m_stride + CACHE_LINE]),
+    m_first(m_buffer.get() + (CACHE_LINE - reinterpret_cast<uintptr_t>(m_buffer.get()) % CACHE_LINE) % CACHE_LINE) {
+    for (size_t i = 0; i < m_shards; i++) {
+        new (&shard(i)) Shard;
+        Slot* shardSlots = slots(i);
+
+        for (size_t slot = 0; slot <= m_mask; slot++) {
+            new (&shardSlots[slot]) Slot;
+        }
+    }
+
+    clear();
+}
+
+TransitionHeatMap::Shard& TransitionHeatMap::shard(const size_t p_shard) const {
+    return *reinterpret_cast<Shard*>(m_first + p_shard * m_stride);
+}
+
+TransitionHeatMap::Slot* TransitionHeatMap::slots(const size_t p_shard) const {
+    return reinterpret_cast<Slot*>(m_first + p_shard * m_stride + CACHE_LINE);
+}
+
+void TransitionHeatMap::record(const State* p_from, const State* p_to, const StateTime p_dwellTime) {
+    const size_t index = threadIndex() % m_shards;
+    Shard& owner = shard(index);
+    Slot* shardSlots = slots(index);
+
+    while (owner.m_lock.test_and_set(std::memory_order_acquire)) {
+    }
+
+    const uintptr_t key = reinterpret_cast<uintptr_t>(p_from) * 31 + reinterpret_cast<uintptr_t>(p_to);
+    const size_t hash = (key ^ (key >> 7) ^ (key >> 17)) & m_mask;
+    bool counted = false;
+
+    // Only this thread writes the shard while it holds the lock, readers see a slot once m_from is set
+    for (size_t probe = 0; probe <= m_mask && !counted; probe++) {
+        Slot& slot = shardSlots[(hash + probe) & m_mask];
+        const State* from = slot.m_from.load(std::memory_order_relaxed);
+
+        if (from == nullptr) {
+            slot.m_to.store(p_to, std::memory_order_relaxed);
+            slot.m_count.store(1, std::memory_order_relaxed);
+            slot.m_dwellTime.store(p_dwellTime, std::memory_order_relaxed);
+            slot.m_from.store(p_from, std::memory_order_release);
+            counted = true;
+        } else if (from == p_from && slot.m_to.load(std::memory_order_relaxed) == p_to) {
+            slot.m_count.store(slot.m_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            slot.m_dwellTime.store(slot.m_dwellTime.load(std::memory_order_relaxed) + p_dwellTime, std::memory_order_relaxed);
+            counted = true;
+        }
+    }
+
+    if (!counted) {
+        owner.m_dropped.store(owner.m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    owner.m_lock.clear(std::memory_order_release);
+}
+
+std::vector<TransitionHeatMap::Edge> TransitionHeatMap::edges() const {
+    std::vector<Edge> edges;
+
+    for (size_t i = 0; i < m_shards; i++) {
+        const Slot* shardSlots = slots(i);
+
+        for (size_t slot = 0; slot <= m_mask; slot++) {
+            const State* from = shardSlots[slot].m_from.load(std::memory_order_acquire);
+
+            if (from == nullptr) {
+                continue;
+            }
+
+            const Edge edge{from, shardSlots[slot].m_to.load(std::memory_order_relaxed),
+                            shardSlots[slot].m_count.load(std::memory_order_relaxed),
+                            shardSlots[slot].m_dwellTime.load(std::memory_order_relaxed)};
+            bool merged = false;
+
+            for (Edge& existing : edges) {
+                if (existing.m_from == edge.m_from && existing.m_to == edge.m_to) {
+                    existing.m_count += edge.m_count;
+                    existing.m_dwellTime += edge.m_dwellTime;
+                    merged = true;
+                    break;
+                }
+            }
+
+            if (!merged) {
+                edges.push_back(edge);
+            }
+        }
+    }
+
+    std::sort(edges.begin(), edges.end(), [](const Edge & p_a, const Edge & p_b) {
+        return p_a.m_count > p_b.m_count;
+    });
+    return edges;
+}
+
+uint64_t TransitionHeatMap::dropped() const {
+    uint64_t dropped = 0;
+
+    for (size_t i = 0; i < m_shards; i++) {
+        dropped += shard(i).m_dropped.load(std::memory_order_relaxed);
+    }
+
+    return dropped;
+}
+
+void TransitionHeatMap::clear() {
+    for (size_t i = 0; i < m_shards; i++) {
+        shard(i).m_lock.clear();
+        shard(i).m_dropped.store(0);
+        Slot* shardSlots = slots(i);
+
+        for (size_t slot = 0; slot <= m_mask; slot++) {
+            shardSlots[slot].m_from.store(nullptr);
+            shardSlots[slot].m_to.store(nullptr);
+            shardSlots[slot].m_count.store(0);
+            shardSlots[slot].m_dwellTime.store(0);
+        }
+    }
+}
+
+// Quoted DOT id for p_state
+static std::string dotName(const State* p_state, const std::vector<const State*>& p_states) {
+    std::string name;
+
+    if (p_state->name() != nullptr) {
+        name = p_state->name();
+    } else {
+        const std::vector<const State*>::const_iterator found = std::find(p_states.begin(), p_states.end(), p_state);
+        char fallback[32];
+        snprintf(fallback, sizeof(fallback), "state%zu", (size_t)(found - p_states.begin()));
+
+        if (found == p_states.end()) {
+            snprintf(fallback, sizeof(fallback), "state@%p", (const void*)p_state);
+        }
+
+        name = fallback;
+    }
+
+    std::string quoted = "\"";
+
+    for (const char c : name) {
+        // Control characters would end or break the quoted id
+        if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            quoted += escaped;
+            continue;
+        }
+
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+
+        quoted += c;
+    }
+
+    return quoted + "\"";
+}
+
+std::string heatMapDot(const TransitionHeatMap& p_heatMap, const std::vector<const State*>& p_states) {
+    const std::vector<TransitionHeatMap::Edge> edges = p_heatMap.edges();
+    const uint64_t most = edges.empty() ? 1 : edges.front().m_count;
+    std::string dot = "digraph heatmap {\n";
+
+    for (const State* state : p_states) {
+        dot += "  " + dotName(state, p_states) + ";\n";
+    }
+
+    for (const TransitionHeatMap::Edge& edge : edges) {
+        const double heat = (double)edge.m_count / most;
+        char attributes[160];
+        // Hue 0.667 is blue for cold edges, 0 is red for the hottest
+        snprintf(attributes, sizeof(attributes), " [label=\"%llu\\navg %.1f\", penwidth=%.2f, color=\"%.3f 1.000 0.900\"];\n",
+                 (unsigned long long)edge.m_count, (double)edge.m_dwellTime / edge.m_count, 1 + 7 * heat, 0.667 * (1 - heat));
+        dot += "  " + dotName(edge.m_from, p_states) + " -> " + dotName(edge.m_to, p_states) + attributes;
+    }
+
+    return dot + "}\n";
+}
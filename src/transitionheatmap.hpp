@@ -0,0 +1,80 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "statemachineclock.hpp"
+
+class State;
+
+/**
+ * Counts how often each transition (edge) is taken and how long the machine stayed in the state it left.
+ * Attach it with StateMachine::setHeatMap() to any number of machines, only available when the library is
+ * build with STATEMACHINE_HEATMAP=1. Each thread counts in its own shard on its own cache lines, so machines
+ * on many threads can share one heat map without contention. edges() merges the shards while they are counting.
+ * Edges that don't fit in a shard are not counted, see dropped().
+ */
+class TransitionHeatMap {
+public:
+    struct Edge {
+        const State* m_from;
+        const State* m_to;
+        uint64_t m_count;
+        // Total time spent in m_from before taking this edge, in the unit of the time passed to handle()
+        uint64_t m_dwellTime;
+    };
+
+private:
+    static const size_t CACHE_LINE = 64;
+
+    struct Slot {
+        std::atomic<const State*> m_from;
+        std::atomic<const State*> m_to;
+        std::atomic<uint64_t> m_count;
+        std::atomic<uint64_t> m_dwellTime;
+    };
+
+    // First cache line of a shard, the slots follow on the next line
+    struct Shard {
+        // Only taken by threads that share the shard, when there are more threads than shards
+        std::atomic_flag m_lock;
+        std::atomic<uint64_t> m_dropped;
+    };
+
+    const size_t m_shards;
+    const size_t m_mask;
+    const size_t m_stride;
+    std::unique_ptr<uint8_t[]> m_buffer;
+    uint8_t* m_first;
+
+    Shard& shard(const size_t p_shard) const;
+    Slot* slots(const size_t p_shard) const;
+
+public:
+    // Each shard holds p_edges edges, rounded up to a power of two. Threads share shards when there are more than p_shards.
+    TransitionHeatMap(const size_t p_edges = 256, const size_t p_shards = 16);
+
+    TransitionHeatMap(const TransitionHeatMap&) = delete;
+    TransitionHeatMap& operator=(const TransitionHeatMap&) = delete;
+
+    // Counts a transition from p_from to p_to after p_dwellTime in p_from, in the shard of the calling thread
+    void record(const State* p_from, const State* p_to, const StateTime p_dwellTime);
+
+    // Counts of all shards added up per edge, most taken first
+    std::vector<Edge> edges() const;
+
+    // Number of transitions that were not counted because a shard was full
+    uint64_t dropped() const;
+
+    // Not thread safe, only call when no machine records
+    void clear();
+};
+
+/**
+ * Graphviz DOT of the edges in p_heatMap. Edges get thicker and go from blue to red the more they are taken,
+ * the label has the count and the average dwell time. States are named after State::name() or their position
+ * in p_states, states in p_states that were never left or entered are drawn as well.
+ */
+std::string heatMapDot(const TransitionHeatMap& p_heatMap, const std::vector<const State*>& p_states = std::vector<const State*>());
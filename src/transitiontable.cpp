@@ -0,0 +1,157 @@
+#include "transitiontable.hpp"
+#include <algorithm>
+#include <unordered_map>
+#include "statelayout.hpp"
+#include "transitionheatmap.hpp"
+
+const uint16_t TransitionTable::NONE;
+
+TransitionTable::TransitionTable() :
+    m_format(FORMAT_AUTO),
+    m_built(false),
+    m_events(0) {
+}
+
+TransitionTable::~TransitionTable() {
+    for (State* state : m_states) {
+        state->m_id = State::NO_ID;
+    }
+}
+
+uint16_t TransitionTable::add(State* p_state) {
+    if (p_state->m_id != State::NO_ID) {
+        return p_state->m_id < m_states.size() && m_states[p_state->m_id] == p_state ? p_state->m_id : State::NO_ID;
+    }
+
+    if (m_states.size() >= State::NO_ID) {
+        return State::NO_ID;
+    }
+
+    p_state->m_id = m_states.size();
+    m_states.push_back(p_state);
+    m_built = false;
+    return p_state->m_id;
+}
+
+bool TransitionTable::on(State* p_from, const EventId p_event, State* p_to, const TAction& p_action) {
+    const uint16_t from = add(p_from);
+
+    if (from == State::NO_ID || add(p_to) == State::NO_ID || m_transitions.size() >= NONE) {
+        return false;
+    }
+
+    for (const Entry& entry : m_entries) {
+        if (entry.m_from == from && entry.m_event == p_event) {
+            return false;
+        }
+    }
+
+    m_entries.push_back(Entry{from, p_event, static_cast<uint16_t>(m_transitions.size())});
+    m_transitions.push_back(Transition{p_to, p_action});
+    m_built = false;
+    return true;
+}
+
+void TransitionTable::reorder(const TransitionHeatMap& p_profile) {
+    // The profile may outlive its states, so only compare its pointers, never dereference them
+    std::unordered_map<const State*, uint16_t> index;
+
+    for (size_t i = 0; i < m_states.size(); i++) {
+        index[m_states[i]] = i;
+    }
+
+    std::vector<StateLayoutEdge> edges;
+
+    for (const TransitionHeatMap::Edge& edge : p_profile.edges()) {
+        const std::unordered_map<const State*, uint16_t>::const_iterator from = index.find(edge.m_from);
+        const std::unordered_map<const State*, uint16_t>::const_iterator to = index.find(edge.m_to);
+
+        if (from != index.end() && to != index.end()) {
+            edges.push_back(StateLayoutEdge{from->second, to->second, edge.m_count});
+        }
+    }
+
+    const std::vector<uint16_t> order = stateLayout(m_states.size(), edges);
+    std::vector<State*> states;
+    std::vector<uint16_t> ids(m_states.size());
+
+    for (const uint16_t id : order) {
+        ids[id] = states.size();
+        states.push_back(m_states[id]);
+        states.back()->m_id = ids[id];
+    }
+
+    for (Entry& entry : m_entries) {
+        entry.m_from = ids[entry.m_from];
+    }
+
+    m_states.swap(states);
+}
+
+void TransitionTable::build(const Format p_format, const TransitionHeatMap* p_profile) {
+    if (p_profile != nullptr) {
+        reorder(*p_profile);
+    }
+
+    m_events = 0;
+
+    for (const Entry& entry : m_entries) {
+        m_events = std::max<size_t>(m_events, entry.m_event + 1);
+    }
+
+    const size_t denseMemory = m_states.size() * m_events * sizeof(uint16_t);
+    const size_t sparseMemory = (m_states.size() + 1) * sizeof(uint32_t) + m_entries.size() * (sizeof(EventId) + sizeof(uint16_t));
+    m_format = p_format != FORMAT_AUTO ? p_format : denseMemory <= 4 * sparseMemory ? FORMAT_DENSE : FORMAT_SPARSE;
+
+    m_matrix.clear();
+    m_rows.clear();
+    m_columnEvents.clear();
+    m_columnTransitions.clear();
+
+    if (m_format == FORMAT_DENSE) {
+        m_matrix.assign(m_states.size() * m_events, NONE);
+
+        for (const Entry& entry : m_entries) {
+            m_matrix[entry.m_from * m_events + entry.m_event] = entry.m_transition;
+        }
+    } else {
+        std::vector<Entry> sorted = m_entries;
+        std::sort(sorted.begin(), sorted.end(), [](const Entry & p_a, const Entry & p_b) {
+            return p_a.m_from != p_b.m_from ? p_a.m_from < p_b.m_from : p_a.m_event < p_b.m_event;
+        });
+        m_rows.assign(m_states.size() + 1, 0);
+
+        for (const Entry& entry : sorted) {
+            m_rows[entry.m_from + 1]++;
+            m_columnEvents.push_back(entry.m_event);
+            m_columnTransitions.push_back(entry.m_transition);
+        }
+
+        for (size_t i = 1; i < m_rows.size(); i++) {
+            m_rows[i] += m_rows[i - 1];
+        }
+    }
+
+    m_built = true;
+}
+
+State* TransitionTable::state(const uint16_t p_id) const {
+    return m_states[p_id];
+}
+
+TransitionTable::Format TransitionTable::format() const {
+    return m_format;
+}
+
+size_t TransitionTable::states() const {
+    return m_states.size();
+}
+
+size_t TransitionTable::size() const {
+    return m_transitions.size();
+}
+
+size_t TransitionTable::memory() const {
+    return m_matrix.size() * sizeof(uint16_t) + m_rows.size() * sizeof(uint32_t) +
+           m_columnEvents.size() * sizeof(EventId) + m_columnTransitions.size() * sizeof(uint16_t);
+}
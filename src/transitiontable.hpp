@@ -0,0 +1,123 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "statemachine.hpp"
+
+class TransitionHeatMap;
+
+/**
+ * Declarative transitions on events: (state, event) -> (target state, optional action).
+ * Attach it with StateMachine::setTransitionTable(), dispatching an event is then one lookup plus the action.
+ * The table gives each of its states an id, a state can be in one table at a time. States must outlive the
+ * table, destroying the table frees them to join another one. States of a machine that are in no table or in
+ * another table react through react() instead.
+ * After adding transitions call build(), it stores them as a dense state x event matrix for small machines
+ * and as compressed sparse rows for large machines with few transitions per state. Pass a heat map recorded
+ * on the machine to build() to renumber the states so the rows of states that follow each other are adjacent.
+ *
+ * TransitionTable table;
+ * table.on(&idle, START, &running);
+ * table.on(&running, STOP, &idle, []() { motor.off(); });
+ * table.build();
+ * machine.setTransitionTable(&table);
+ */
+class TransitionTable {
+public:
+    typedef InplaceFunction<void()> TAction;
+
+    enum Format : uint8_t {
+        // Dense unless the matrix takes more than 4 times the memory of the sparse rows
+        FORMAT_AUTO,
+        FORMAT_DENSE,
+        FORMAT_SPARSE
+    };
+
+    struct Transition {
+        State* m_to;
+        TAction m_action;
+    };
+
+private:
+    static const uint16_t NONE = 0xFFFF;
+
+    struct Entry {
+        uint16_t m_from;
+        EventId m_event;
+        uint16_t m_transition;
+    };
+
+    std::vector<State*> m_states;
+    std::vector<Transition> m_transitions;
+    std::vector<Entry> m_entries;
+    Format m_format;
+    bool m_built;
+    // Highest event id + 1
+    size_t m_events;
+    // Dense: transition index for state * m_events + event, NONE without transition
+    std::vector<uint16_t> m_matrix;
+    // Sparse: entries of a state are m_rows[state] up to m_rows[state + 1], sorted by event
+    std::vector<uint32_t> m_rows;
+    std::vector<EventId> m_columnEvents;
+    std::vector<uint16_t> m_columnTransitions;
+
+    // Gives the states new ids in layout order of the edges in p_profile
+    void reorder(const TransitionHeatMap& p_profile);
+
+public:
+    TransitionTable();
+    ~TransitionTable();
+
+    TransitionTable(const TransitionTable&) = delete;
+    TransitionTable& operator=(const TransitionTable&) = delete;
+
+    // Adds p_state to the table, returns its id or State::NO_ID when it already is in another table or the table is full
+    uint16_t add(State* p_state);
+
+    // Adds a transition from p_from to p_to on p_event, states are added when needed.
+    // Returns false when a state can't be added or there already is a transition for p_from and p_event
+    bool on(State* p_from, const EventId p_event, State* p_to, const TAction& p_action = nullptr);
+
+    // Builds the lookup structure, call after adding all transitions. With p_profile the states are first given
+    // new ids in the order of stateLayout() over the edges counted in it.
+    void build(const Format p_format = FORMAT_AUTO, const TransitionHeatMap* p_profile = nullptr);
+
+    // Format chosen by build()
+    Format format() const;
+
+    // State with id p_id
+    State* state(const uint16_t p_id) const;
+
+    // Number of states and of transitions
+    size_t states() const;
+    size_t size() const;
+
+    // Bytes used by the lookup structure
+    size_t memory() const;
+
+    // Transition for p_event in p_from or nullptr when there is none or the table is not built
+    inline const Transition* find(const State* p_from, const EventId p_event) const {
+        const uint16_t from = p_from->m_id;
+
+        // A state of another table or a copy of one of ours can have an id that is ours as well
+        if (from >= m_states.size() || m_states[from] != p_from || p_event >= m_events || !m_built) {
+            return nullptr;
+        }
+
+        uint16_t transition = NONE;
+
+        if (m_format == FORMAT_DENSE) {
+            transition = m_matrix[from * m_events + p_event];
+        } else {
+            // Rows are short, a linear scan beats a binary search
+            for (uint32_t i = m_rows[from]; i < m_rows[from + 1]; i++) {
+                if (m_columnEvents[i] == p_event) {
+                    transition = m_columnTransitions[i];
+                    break;
+                }
+            }
+        }
+
+        return transition == NONE ? nullptr : &m_transitions[transition];
+    }
+};
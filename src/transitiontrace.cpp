@@ -0,0 +1,37 @@
+#include "transitiontrace.hpp"
+
+static size_t roundUpToPowerOfTwo(const size_t p_value) {
+    size_t value = 1;
+
+    while (value < p_value) {
+        value <<= 1;
+    }
+
+    return value;
+}
+
+TransitionTrace::TransitionTrace(const size_t p_capacity) :
+    m_records(new TransitionRecord[roundUpToPowerOfTwo(p_capacity)]),
+    m_mask(roundUpToPowerOfTwo(p_capacity) - 1),
+    m_count(0) {
+}
+
+size_t TransitionTrace::capacity() const {
+    return m_mask + 1;
+}
+
+size_t TransitionTrace::size() const {
+    return m_count < capacity() ? m_count : capacity();
+}
+
+size_t TransitionTrace::total() const {
+    return m_count;
+}
+
+const TransitionRecord& TransitionTrace::operator[](const size_t p_index) const {
+    return m_records[(m_count - size() + p_index) & m_mask];
+}
+
+void TransitionTrace::clear() {
+    m_count = 0;
+}
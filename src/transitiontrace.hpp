@@ -0,0 +1,56 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+#include "statemachineclock.hpp"
+
+class State;
+
+/**
+ * One transition of a StateMachine
+ */
+struct TransitionRecord {
+    StateTime m_time;
+    const State* m_from;
+    const State* m_to;
+};
+
+/**
+ * Ring buffer with the last transitions of a StateMachine, older records are overwritten.
+ * Attach it with StateMachine::setTrace(), only available when the library is build with STATEMACHINE_TRACE=1
+ * The buffer is allocated once when the trace is created.
+ */
+class TransitionTrace {
+private:
+    std::unique_ptr<TransitionRecord[]> m_records;
+    const size_t m_mask;
+    size_t m_count;
+
+public:
+    // p_capacity is rounded up to a power of two
+    TransitionTrace(const size_t p_capacity);
+
+    TransitionTrace(const TransitionTrace&) = delete;
+    TransitionTrace& operator=(const TransitionTrace&) = delete;
+
+    inline void record(const StateTime p_time, const State* p_from, const State* p_to) {
+        TransitionRecord& record = m_records[m_count & m_mask];
+        record.m_time = p_time;
+        record.m_from = p_from;
+        record.m_to = p_to;
+        m_count++;
+    }
+
+    size_t capacity() const;
+
+    // Number of records available, at most capacity()
+    size_t size() const;
+
+    // Total number of transitions recorded, including overwritten ones
+    size_t total() const;
+
+    // Record p_index where 0 is the oldest available record
+    const TransitionRecord& operator[](const size_t p_index) const;
+
+    void clear();
+};
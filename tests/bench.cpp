@@ -0,0 +1,22 @@
+#include "bench/benchmark.hpp"
+#include "bench/bench_statemachine.hpp"
+#include "bench/bench_staticstatemachine.hpp"
+#include "bench/bench_indexedstatemachine.hpp"
+#include "bench/bench_statemachinegroup.hpp"
+#include "bench/bench_events.hpp"
+#include "bench/bench_statemachineexecutor.hpp"
+#include "bench/bench_statemachinedefinition.hpp"
+#include "bench/bench_statearena.hpp"
+#include "bench/bench_statemachineclock.hpp"
+#include "bench/bench_statemachinesimulation.hpp"
+#include "bench/bench_runtocompletion.hpp"
+#include "bench/bench_transitiontable.hpp"
+#include "bench/bench_statelayout.hpp"
+#include "bench/bench_statemachineimage.hpp"
+#include "bench/bench_statemachinegen.hpp"
+
+#include "src/arduinostubs.hpp"
+
+int main(int argc, char** argv) {
+    return bench::runAll(argc, argv);
+}
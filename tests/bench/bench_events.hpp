@@ -0,0 +1,89 @@
+#include "benchmark.hpp"
+
+#include <memory>
+#include <statemachine.hpp>
+#include <statemachinegroup.hpp>
+
+namespace events_bench {
+
+const EventId CONNECTED = 1;
+const size_t MACHINES = 5000;
+
+// Waits for a connection by checking a flag on every handle()
+struct PollingSession {
+    bool m_connected = false;
+    State m_waiting;
+    State m_connected_state;
+    PollingSession() {
+        m_waiting.setRunnable([this]() {
+            return m_connected ? &m_connected_state : &m_waiting;
+        });
+    }
+};
+
+// Waits for a connection event
+struct EventSession {
+    StateEvents<> m_waiting;
+    State m_connected_state;
+    EventSession() {
+        m_waiting.on(CONNECTED, [this]() {
+            return &m_connected_state;
+        });
+    }
+};
+
+void pollingIdle(bench::Run& run) {
+    std::vector<std::unique_ptr<PollingSession>> sessions;
+    StateMachineGroup group{MACHINES};
+
+    for (size_t i = 0; i < MACHINES; i++) {
+        sessions.emplace_back(new PollingSession);
+        group.add(&sessions.back()->m_waiting);
+    }
+
+    group.start();
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        group.handle();
+    }
+}
+
+void eventIdle(bench::Run& run) {
+    std::vector<std::unique_ptr<EventSession>> sessions;
+    StateMachineGroup group{MACHINES};
+
+    for (size_t i = 0; i < MACHINES; i++) {
+        sessions.emplace_back(new EventSession);
+        group.add(&sessions.back()->m_waiting);
+    }
+
+    group.start();
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        group.handle();
+    }
+}
+
+void eventDispatch(bench::Run& run) {
+    EventSession session;
+    StateMachine machine{&session.m_waiting};
+    machine.start();
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        machine.dispatch(CONNECTED);
+        machine.dispatch(CONNECTED + 1);
+        bench::doNotOptimize(machine);
+    }
+}
+
+BENCHMARK("StateMachineGroup: 5000 idle machines polling a flag, per handle()", pollingIdle);
+BENCHMARK("StateMachineGroup: 5000 idle machines waiting for an event, per handle()", eventIdle);
+BENCHMARK("StateMachine: dispatch() of an event with and without reaction", eventDispatch);
+
+}
@@ -0,0 +1,45 @@
+#include "benchmark.hpp"
+
+#include <memory>
+#include <vector>
+#include <indexedstatemachine.hpp>
+
+namespace indexedstatemachine_bench {
+
+struct PingPong {
+    IndexedStateMachine<2> m_machine;
+
+    PingPong() {
+        const auto ping = m_machine.add();
+        const auto pong = m_machine.add();
+        m_machine.setRunnable(ping, [pong]() {
+            return pong;
+        });
+        m_machine.setRunnable(pong, [ping]() {
+            return ping;
+        });
+    }
+};
+
+// Same as the core State -> State transition benchmark with the states inside the machine
+void transition(bench::Run& run, const size_t p_machines) {
+    std::vector<std::unique_ptr<PingPong>> machines;
+
+    for (size_t i = 0; i < p_machines; i++) {
+        machines.emplace_back(new PingPong);
+        machines.back()->m_machine.start(0);
+    }
+
+    run.setBytesPerMachine(sizeof(PingPong));
+    run.start();
+
+    for (uint64_t done = 0; done < run.iterations; done += p_machines) {
+        for (auto& machine : machines) {
+            machine->m_machine.handle(0);
+        }
+    }
+}
+
+BENCHMARK("IndexedStateMachine: state -> state transition", bench::machineCounts(), transition);
+
+}
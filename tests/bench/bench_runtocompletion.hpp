@@ -0,0 +1,51 @@
+#include "benchmark.hpp"
+
+#include <statemachine.hpp>
+
+/**
+ * Latency of a chain of states ending in a StateTimed{0}, every op is one trip through the whole chain.
+ * One transition per handle() needs a handle() per hop, run to completion does the trip in one handle().
+ */
+namespace runtocompletion_bench {
+
+const size_t HOPS = 8;
+
+void chain(bench::Run& run, const uint8_t p_maxHops) {
+    State states[HOPS - 1];
+    StateTimed last{0};
+
+    for (size_t i = 0; i < HOPS - 1; i++) {
+        State* next = i + 1 < HOPS - 1 ? &states[i + 1] : &last;
+        states[i].setRunnable([next]() {
+            return next;
+        });
+    }
+
+    last.setRunnable([&states]() {
+        return &states[0];
+    });
+
+    StateMachine machine{&states[0]};
+    machine.setRunToCompletion(p_maxHops);
+    machine.start(0);
+    StateTime time = 0;
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        // Wait of the StateTimed{0} ends on the next tick
+        time++;
+
+        do {
+            machine.handle(time);
+        } while (!machine.current(&last));
+    }
+}
+
+BENCHMARK("run to completion: 8 hop chain, one transition per handle()", [](bench::Run & run) {
+    chain(run, 1);
+});
+BENCHMARK("run to completion: 8 hop chain, run to completion", [](bench::Run & run) {
+    chain(run, HOPS);
+});
+
+}
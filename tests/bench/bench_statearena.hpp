@@ -0,0 +1,105 @@
+#include "benchmark.hpp"
+
+#include <vector>
+#include <statemachine.hpp>
+
+/**
+ * DeletingStateMachine with states created one by one with new against states in a StateArena.
+ * Compare construction and teardown with "core: DeletingStateMachine construct and teardown".
+ */
+namespace statearena_bench {
+
+// Builds a machine of three states in an arena, the same machine as the core benchmark
+DeletingStateMachine* arenaMachine() {
+    StateArena arena{StateArena::sizeFor<State, StateTimed, State>()};
+    auto first = arena.create<State>();
+    auto second = arena.create<StateTimed>(10);
+    auto third = arena.create<State>();
+    first->setRunnable([second]() {
+        return second;
+    });
+    second->setRunnable([third]() {
+        return third;
+    });
+    return new DeletingStateMachine(first, std::move(arena));
+}
+
+void constructTeardown(bench::Run& run, const size_t p_machines) {
+    std::vector<DeletingStateMachine*> machines(p_machines);
+    run.start();
+
+    for (uint64_t done = 0; done < run.iterations; done += p_machines) {
+        for (size_t i = 0; i < p_machines; i++) {
+            machines[i] = arenaMachine();
+        }
+
+        for (size_t i = 0; i < p_machines; i++) {
+            delete machines[i];
+        }
+    }
+}
+
+// Ping pong machines, with new the states of all machines are created round by round as happens when
+// machines are built over time, so the two states of one machine are far apart
+void tick(bench::Run& run, const size_t p_machines, const bool p_arena) {
+    std::vector<DeletingStateMachine*> machines(p_machines);
+
+    if (p_arena) {
+        for (size_t i = 0; i < p_machines; i++) {
+            StateArena arena{StateArena::sizeFor<State, State>()};
+            auto ping = arena.create<State>();
+            auto pong = arena.create<State>();
+            ping->setRunnable([pong]() {
+                return pong;
+            });
+            pong->setRunnable([ping]() {
+                return ping;
+            });
+            machines[i] = new DeletingStateMachine(ping, std::move(arena));
+        }
+    } else {
+        std::vector<State*> pings(p_machines);
+
+        for (size_t i = 0; i < p_machines; i++) {
+            pings[i] = new State;
+        }
+
+        for (size_t i = 0; i < p_machines; i++) {
+            State* ping = pings[i];
+            State* pong = new State;
+            ping->setRunnable([pong]() {
+                return pong;
+            });
+            pong->setRunnable([ping]() {
+                return ping;
+            });
+            machines[i] = new DeletingStateMachine(ping, {ping, pong});
+        }
+    }
+
+    for (DeletingStateMachine* machine : machines) {
+        machine->start();
+    }
+
+    run.start();
+
+    for (uint64_t done = 0; done < run.iterations; done += p_machines) {
+        for (DeletingStateMachine* machine : machines) {
+            machine->handle(0);
+        }
+    }
+
+    for (DeletingStateMachine* machine : machines) {
+        delete machine;
+    }
+}
+
+BENCHMARK("arena: DeletingStateMachine construct and teardown", bench::machineCounts(), constructTeardown);
+BENCHMARK("arena: tick with states created by new", bench::machineCounts(), [](bench::Run & run, const size_t p_machines) {
+    tick(run, p_machines, false);
+});
+BENCHMARK("arena: tick with states in a StateArena", bench::machineCounts(), [](bench::Run & run, const size_t p_machines) {
+    tick(run, p_machines, true);
+});
+
+}
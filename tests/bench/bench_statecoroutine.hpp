@@ -0,0 +1,89 @@
+#include "benchmark.hpp"
+
+#include <statecoroutine.hpp>
+
+/**
+ * Connect flow that fails twice, retries after 100ms and then waits to be disconnected.
+ * Written as a chain of states and as one coroutine, every op is one connect and disconnect.
+ * The chain runs to completion so both need the same number of handle() calls.
+ */
+namespace statecoroutine_bench {
+
+const EventId DISCONNECTED = 1;
+
+struct Link {
+    uint32_t m_attempts = 0;
+    uint32_t m_connects = 0;
+
+    bool connect() {
+        if (++m_attempts % 3 != 0) {
+            return false;
+        }
+
+        m_connects++;
+        return true;
+    }
+};
+
+struct Chain {
+    Link m_link;
+    State m_connecting;
+    StateTimed m_retry{100};
+    StateEvents<> m_connected;
+    StateMachine m_machine{&m_connecting};
+
+    Chain() {
+        m_connecting.setRunnable([this]() -> State* {
+            if (m_link.connect()) {
+                return &m_connected;
+            }
+
+            return &m_retry;
+        });
+        m_retry.setRunnable([this]() {
+            return &m_connecting;
+        });
+        m_connected.on(DISCONNECTED, [this]() {
+            return &m_connecting;
+        });
+        m_machine.setRunToCompletion(4);
+    }
+};
+
+struct Coroutine {
+    Link m_link;
+    StateCoroutinePool m_pool{256, 1};
+    StateCoroutine m_session{m_pool, [this](StateCoroutine & self) -> StateTask {
+        while (!m_link.connect()) {
+            co_await self.delay(100);
+        }
+
+        co_await self.event(DISCONNECTED);
+        co_return &self;
+    }};
+    StateMachine m_machine{&m_session};
+};
+
+template<typename T>
+void session(bench::Run& run) {
+    T flow;
+    StateTime time = 0;
+    flow.m_machine.start(time);
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        const uint32_t connects = flow.m_link.m_connects;
+
+        while (flow.m_link.m_connects == connects) {
+            time += 101;
+            flow.m_machine.handle(time);
+        }
+
+        flow.m_machine.dispatch(DISCONNECTED, time);
+    }
+}
+
+BENCHMARK("coroutine: connect flow as a chain of states", session<Chain>);
+BENCHMARK("coroutine: connect flow as a StateCoroutine", session<Coroutine>);
+
+}
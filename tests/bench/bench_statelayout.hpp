@@ -0,0 +1,76 @@
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <statelayout.hpp>
+#include <statemachinedefinition.hpp>
+
+/**
+ * A StateMachineDefinition of 1000 states of which 500 form the hot path, a loop through them in a random order.
+ * The other states are only entered on rare events that don't happen here. Added in id order the hot states
+ * are spread over all the states and take more cache lines than L1 has, laid out by a profile they fit.
+ * Every op is one transition.
+ */
+namespace statelayout_bench {
+
+const size_t STATES = 1000;
+const size_t HOT = 500;
+
+// Returns the first state of the hot path
+StateId buildMachine(StateMachineDefinition& p_definition) {
+    std::vector<StateId> cycle;
+
+    for (size_t i = 0; i < STATES; i++) {
+        cycle.push_back(p_definition.add());
+    }
+
+    std::mt19937 random{42};
+    std::shuffle(cycle.begin(), cycle.end(), random);
+
+    for (size_t i = 0; i < STATES; i++) {
+        // Cold states go back to the hot path
+        const StateId next = i < HOT ? cycle[(i + 1) % HOT] : cycle[i % HOT];
+        p_definition.setRunnable(cycle[i], [next](const StateMachineInstance&) {
+            return next;
+        });
+    }
+
+    return cycle[0];
+}
+
+void hotPath(bench::Run& run, const bool p_freeze) {
+    StateMachineDefinition definition;
+    const StateId first = buildMachine(definition);
+    StateMachineInstance instance;
+    definition.start(instance, first, 0);
+
+    if (p_freeze) {
+        StateLayoutProfile profile;
+
+        for (size_t i = 0; i < 2 * HOT; i++) {
+            const StateId before = instance.state();
+            definition.handle(instance, 0);
+            profile.record(before, instance.state());
+        }
+
+        definition.freeze(profile.edges());
+    }
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        definition.handle(instance, 0);
+        bench::doNotOptimize(instance);
+    }
+}
+
+BENCHMARK("state layout: 500 hot of 1000 states, in the order they were added", [](bench::Run& run) {
+    hotPath(run, false);
+});
+BENCHMARK("state layout: 500 hot of 1000 states, frozen with a profile", [](bench::Run& run) {
+    hotPath(run, true);
+});
+
+}
@@ -0,0 +1,146 @@
+#include "benchmark.hpp"
+
+#include <memory>
+#include <statemachine.hpp>
+#include "../src/arduinostubs.hpp"
+
+/**
+ * Hot path of StateMachine::handle() for increasing numbers of machines, every op is one handle() of one machine
+ */
+namespace statemachine_bench {
+
+struct SelfLoop {
+    uint32_t m_count = 0;
+    State m_state;
+    StateMachine m_machine{&m_state};
+    SelfLoop() {
+        m_state.setRunnable([this]() {
+            m_count++;
+            return &m_state;
+        });
+    }
+};
+
+struct PingPong {
+    State m_ping;
+    State m_pong;
+    StateMachine m_machine{&m_ping};
+    PingPong() {
+        m_ping.setRunnable([this]() {
+            return &m_pong;
+        });
+        m_pong.setRunnable([this]() {
+            return &m_ping;
+        });
+    }
+};
+
+struct Timed {
+    StateTimed m_wait;
+    StateMachine m_machine{&m_wait};
+    Timed(const uint32_t p_forTime) : m_wait(p_forTime) {
+        m_wait.setRunnable([this]() {
+            return &m_wait;
+        });
+    }
+};
+
+// Handles every machine in turn until run.iterations handles are done
+template<typename T>
+void handleAll(bench::Run& run, std::vector<std::unique_ptr<T>>& p_machines, const bool p_advanceTime) {
+    for (auto& machine : p_machines) {
+        machine->m_machine.start();
+    }
+
+    run.start();
+    uint64_t handled = 0;
+
+    while (handled < run.iterations) {
+        if (p_advanceTime) {
+            millisStubbed++;
+        }
+
+        for (auto& machine : p_machines) {
+            machine->m_machine.handle();
+        }
+
+        handled += p_machines.size();
+    }
+}
+
+void selfLoop(bench::Run& run, const size_t p_machines) {
+    std::vector<std::unique_ptr<SelfLoop>> machines;
+
+    for (size_t i = 0; i < p_machines; i++) {
+        machines.emplace_back(new SelfLoop);
+    }
+
+    handleAll(run, machines, false);
+    bench::doNotOptimize(machines.front()->m_count);
+}
+
+void transition(bench::Run& run, const size_t p_machines) {
+    std::vector<std::unique_ptr<PingPong>> machines;
+
+    for (size_t i = 0; i < p_machines; i++) {
+        machines.emplace_back(new PingPong);
+    }
+
+    handleAll(run, machines, false);
+}
+
+void timedWaiting(bench::Run& run, const size_t p_machines) {
+    std::vector<std::unique_ptr<Timed>> machines;
+    millisStubbed = 0;
+
+    for (size_t i = 0; i < p_machines; i++) {
+        machines.emplace_back(new Timed(0xFFFFFFF));
+    }
+
+    handleAll(run, machines, false);
+}
+
+void timedExpiring(bench::Run& run, const size_t p_machines) {
+    std::vector<std::unique_ptr<Timed>> machines;
+    millisStubbed = 0;
+
+    // Waits 0ms so the wait is over on every tick
+    for (size_t i = 0; i < p_machines; i++) {
+        machines.emplace_back(new Timed(0));
+    }
+
+    handleAll(run, machines, true);
+}
+
+// Builds and deletes machines like an application creating sessions, every op is one machine with 3 states
+void deletingConstructTeardown(bench::Run& run, const size_t p_machines) {
+    std::vector<DeletingStateMachine*> machines(p_machines);
+    run.start();
+
+    for (uint64_t done = 0; done < run.iterations; done += p_machines) {
+        for (size_t i = 0; i < p_machines; i++) {
+            auto first = new State;
+            auto second = new StateTimed{10};
+            auto third = new State;
+            first->setRunnable([second]() {
+                return second;
+            });
+            second->setRunnable([third]() {
+                return third;
+            });
+            machines[i] = new DeletingStateMachine(first, {first, second, third});
+        }
+
+        for (size_t i = 0; i < p_machines; i++) {
+            delete machines[i];
+        }
+    }
+}
+
+BENCHMARK("core: self looping State tick", bench::machineCounts(), selfLoop);
+BENCHMARK("core: State -> State transition", bench::machineCounts(), transition);
+BENCHMARK("core: StateTimed waiting", bench::machineCounts(), timedWaiting);
+BENCHMARK("core: StateTimed expiring", bench::machineCounts(), timedExpiring);
+BENCHMARK("core: DeletingStateMachine construct and teardown", bench::machineCounts(), deletingConstructTeardown);
+
+}
@@ -0,0 +1,49 @@
+#include "benchmark.hpp"
+
+#include <statemachine.hpp>
+
+/**
+ * Cost of reading the time in handle(), one self looping machine
+ */
+namespace statemachineclock_bench {
+
+template<typename Machine, typename Handle>
+void selfLoop(bench::Run& run, Handle p_handle) {
+    State loop;
+    loop.setRunnable([&loop]() {
+        return &loop;
+    });
+    Machine machine{&loop};
+    machine.start();
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        p_handle(machine);
+        bench::doNotOptimize(machine);
+    }
+}
+
+BENCHMARK("clock: handle() with a time you already have", [](bench::Run & run) {
+    selfLoop<StateMachine>(run, [](StateMachine & machine) {
+        machine.handle(0);
+    });
+});
+BENCHMARK("clock: handle() with millis()", [](bench::Run & run) {
+    selfLoop<StateMachine>(run, [](StateMachine & machine) {
+        machine.handle();
+    });
+});
+BENCHMARK("clock: handle() with MillisClock", [](bench::Run & run) {
+    selfLoop<ClockedStateMachine<MillisClock>>(run, [](ClockedStateMachine<MillisClock>& machine) {
+        machine.handle();
+    });
+});
+BENCHMARK("clock: handle() with SteadyClock in nanoseconds", [](bench::Run & run) {
+    typedef ClockedStateMachine<SteadyClock<std::chrono::nanoseconds>> TMachine;
+    selfLoop<TMachine>(run, [](TMachine & machine) {
+        machine.handle();
+    });
+});
+
+}
@@ -0,0 +1,101 @@
+#include "benchmark.hpp"
+
+#include <cstdlib>
+#include <memory>
+#include <statemachine.hpp>
+#include <statemachinedefinition.hpp>
+
+// mallinfo2() needs glibc 2.33, the version check only parses with glibc
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+#include <malloc.h>
+#define STATEMACHINE_BENCH_HEAP_USED 1
+#endif
+#endif
+
+/**
+ * Device sessions of three states, each with its own State objects or all sharing one StateMachineDefinition.
+ * Every op is one handle() of one session, memory is what the heap grew by while building the sessions.
+ */
+namespace statemachinedefinition_bench {
+
+struct Session {
+    State m_connect;
+    StateTimed m_wait{0xFFFFFFF};
+    State m_done;
+    StateMachine m_machine{&m_connect};
+
+    Session() {
+        m_connect.setRunnable([this]() {
+            return &m_wait;
+        });
+        m_wait.setRunnable([this]() {
+            return &m_done;
+        });
+    }
+};
+
+// Bytes allocated on the heap, 0 where glibc can't tell so memory is not reported
+inline size_t heapUsed() {
+#ifdef STATEMACHINE_BENCH_HEAP_USED
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+void copiedStates(bench::Run& run, const size_t p_machines) {
+    const size_t before = heapUsed();
+    std::vector<std::unique_ptr<Session>> sessions;
+    sessions.reserve(p_machines);
+
+    for (size_t i = 0; i < p_machines; i++) {
+        sessions.emplace_back(new Session);
+        sessions.back()->m_machine.start();
+    }
+
+    run.setBytesPerMachine((double)(heapUsed() - before) / p_machines);
+    run.start();
+
+    for (uint64_t done = 0; done < run.iterations; done += p_machines) {
+        for (auto& session : sessions) {
+            session->m_machine.handle(0);
+        }
+    }
+}
+
+void sharedDefinition(bench::Run& run, const size_t p_machines) {
+    const size_t before = heapUsed();
+    StateMachineDefinition definition;
+    const StateId connect = definition.add();
+    const StateId wait = definition.addTimed(0xFFFFFFF);
+    const StateId done = definition.add();
+    definition.setRunnable(connect, [wait](const StateMachineInstance&) {
+        return wait;
+    });
+    definition.setRunnable(wait, [done](const StateMachineInstance&) {
+        return done;
+    });
+
+    std::vector<StateMachineInstance> sessions(p_machines);
+
+    for (StateMachineInstance& session : sessions) {
+        definition.start(session, connect, 0);
+    }
+
+    run.setBytesPerMachine((double)(heapUsed() - before) / p_machines);
+    run.start();
+
+    for (uint64_t done = 0; done < run.iterations; done += p_machines) {
+        for (StateMachineInstance& session : sessions) {
+            definition.handle(session, 0);
+        }
+    }
+
+    bench::doNotOptimize(sessions.front());
+}
+
+BENCHMARK("flyweight: State objects per session", {1000, 10000, 1000000}, copiedStates);
+BENCHMARK("flyweight: shared StateMachineDefinition", {1000, 10000, 1000000}, sharedDefinition);
+
+}
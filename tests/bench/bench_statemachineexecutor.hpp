@@ -0,0 +1,58 @@
+#include "benchmark.hpp"
+
+#include <memory>
+#include <statemachineexecutor.hpp>
+
+namespace statemachineexecutor_bench {
+
+const size_t MACHINES = 100000;
+
+// A device session doing a little work on every tick
+struct Session {
+    uint32_t m_value = 1;
+    State m_state;
+    StateMachine m_machine{&m_state};
+    Session() {
+        m_state.setRunnable([this]() {
+            for (uint8_t i = 0; i < 16; i++) {
+                m_value = m_value * 1664525 + 1013904223;
+            }
+
+            return &m_state;
+        });
+    }
+};
+
+void executorThreads(bench::Run& run, const size_t p_threads) {
+    std::vector<std::unique_ptr<Session>> sessions;
+    StateMachineExecutor executor{p_threads};
+
+    for (size_t i = 0; i < MACHINES; i++) {
+        sessions.emplace_back(new Session);
+        executor.add(&sessions.back()->m_machine);
+        sessions.back()->m_machine.start();
+    }
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i += MACHINES) {
+        executor.handle();
+    }
+
+    bench::doNotOptimize(sessions.front()->m_value);
+}
+
+BENCHMARK("StateMachineExecutor: 100000 machines, 1 thread, per machine tick", [](bench::Run& run) {
+    executorThreads(run, 1);
+});
+BENCHMARK("StateMachineExecutor: 100000 machines, 2 threads, per machine tick", [](bench::Run& run) {
+    executorThreads(run, 2);
+});
+BENCHMARK("StateMachineExecutor: 100000 machines, 4 threads, per machine tick", [](bench::Run& run) {
+    executorThreads(run, 4);
+});
+BENCHMARK("StateMachineExecutor: 100000 machines, 8 threads, per machine tick", [](bench::Run& run) {
+    executorThreads(run, 8);
+});
+
+}
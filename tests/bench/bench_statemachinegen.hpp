@@ -0,0 +1,203 @@
+#include "benchmark.hpp"
+
+#include <statemachine.hpp>
+#include <tcpconnection.hpp>
+
+/**
+ * The TCP connection of tests/machines/tcp.json, generated by statemachinegen and written by hand
+ * as a graph of State objects. Each op is one event or timeout of an active and a passive open and close.
+ */
+namespace statemachinegen_bench {
+
+enum : EventId { PASSIVE_OPEN, ACTIVE_OPEN, SEND, CLOSE, SYN, SYN_ACK, ACK, FIN, FIN_ACK, RST, TICK };
+
+const EventId LIFECYCLE[] = {
+    ACTIVE_OPEN, SYN_ACK, SEND, SEND, CLOSE, ACK, FIN, TICK,
+    PASSIVE_OPEN, SYN, ACK, SEND, FIN, CLOSE, ACK, TICK
+};
+const size_t STEPS = sizeof(LIFECYCLE) / sizeof(LIFECYCLE[0]);
+
+struct Generated : TcpConnection<Generated> {
+    uint32_t m_sent = 0;
+    bool m_passive = false;
+
+    void listening() {
+        m_passive = true;
+    }
+    void sendSyn() {
+        m_passive = false;
+        m_sent++;
+    }
+    void sendSynAck() {
+        m_sent++;
+    }
+    void sendAck() {
+        m_sent++;
+    }
+    void sendFin() {
+        m_sent++;
+    }
+    void connectFailed() {
+    }
+    bool passive() {
+        return m_passive;
+    }
+};
+
+struct Graph {
+    uint32_t m_sent = 0;
+    bool m_passive = false;
+    StateEvents<> m_closed;
+    StateEvents<> m_listen;
+    StateEvents<StateTimed> m_synSent{3000};
+    StateEvents<StateTimed> m_synReceived{3000};
+    StateEvents<> m_established;
+    StateEvents<> m_finWait1;
+    StateEvents<> m_finWait2;
+    StateEvents<> m_closeWait;
+    StateEvents<> m_closing;
+    StateEvents<> m_lastAck;
+    StateTimed m_timeWait{240000};
+    StateMachine m_machine{&m_closed};
+
+    Graph() {
+        m_closed.on(PASSIVE_OPEN, [this]() {
+            m_passive = true;
+            return &m_listen;
+        });
+        m_closed.on(ACTIVE_OPEN, [this]() {
+            m_passive = false;
+            m_sent++;
+            return &m_synSent;
+        });
+        m_listen.on(SYN, [this]() {
+            m_sent++;
+            return &m_synReceived;
+        });
+        m_listen.on(SEND, [this]() {
+            m_passive = false;
+            m_sent++;
+            return &m_synSent;
+        });
+        m_listen.on(CLOSE, [this]() {
+            return &m_closed;
+        });
+        m_synSent.setRunnable([this]() {
+            return &m_closed;
+        });
+        m_synSent.on(SYN_ACK, [this]() {
+            m_sent++;
+            return &m_established;
+        });
+        m_synSent.on(SYN, [this]() {
+            m_sent++;
+            return &m_synReceived;
+        });
+        m_synSent.on(CLOSE, [this]() {
+            return &m_closed;
+        });
+        m_synReceived.setRunnable([this]() {
+            return &m_closed;
+        });
+        m_synReceived.on(ACK, [this]() {
+            return &m_established;
+        });
+        m_synReceived.on(CLOSE, [this]() {
+            m_sent++;
+            return &m_finWait1;
+        });
+        m_synReceived.on(RST, [this]() -> State* {
+            return m_passive ? static_cast<State*>(&m_listen) : &m_closed;
+        });
+        m_established.on(CLOSE, [this]() {
+            m_sent++;
+            return &m_finWait1;
+        });
+        m_established.on(FIN, [this]() {
+            m_sent++;
+            return &m_closeWait;
+        });
+        m_established.on(RST, [this]() {
+            return &m_closed;
+        });
+        m_finWait1.on(ACK, [this]() {
+            return &m_finWait2;
+        });
+        m_finWait1.on(FIN, [this]() {
+            m_sent++;
+            return &m_closing;
+        });
+        m_finWait1.on(FIN_ACK, [this]() {
+            m_sent++;
+            return &m_timeWait;
+        });
+        m_finWait2.on(FIN, [this]() {
+            m_sent++;
+            return &m_timeWait;
+        });
+        m_closeWait.on(CLOSE, [this]() {
+            m_sent++;
+            return &m_lastAck;
+        });
+        m_closing.on(ACK, [this]() {
+            return &m_timeWait;
+        });
+        m_lastAck.on(ACK, [this]() {
+            return &m_closed;
+        });
+        m_timeWait.setRunnable([this]() {
+            return &m_closed;
+        });
+    }
+};
+
+void generatedLifecycle(bench::Run& run) {
+    Generated connection;
+    StateTime time = 0;
+    connection.start(time);
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        const EventId event = LIFECYCLE[i % STEPS];
+
+        if (event == TICK) {
+            time += 300000;
+            connection.handle(time);
+        } else {
+            connection.dispatch(event, time);
+        }
+
+        bench::doNotOptimize(connection);
+    }
+
+    bench::doNotOptimize(connection.m_sent);
+}
+
+void graphLifecycle(bench::Run& run) {
+    Graph connection;
+    StateTime time = 0;
+    connection.m_machine.start(time);
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        const EventId event = LIFECYCLE[i % STEPS];
+
+        if (event == TICK) {
+            time += 300000;
+            connection.m_machine.handle(time);
+        } else {
+            connection.m_machine.dispatch(event, time);
+        }
+
+        bench::doNotOptimize(connection.m_machine);
+    }
+
+    bench::doNotOptimize(connection.m_sent);
+}
+
+BENCHMARK("statemachinegen: generated TCP connection, per event", generatedLifecycle);
+BENCHMARK("statemachinegen: State graph TCP connection, per event", graphLifecycle);
+
+}
@@ -0,0 +1,128 @@
+#include "benchmark.hpp"
+
+#include <memory>
+#include <statemachine.hpp>
+#include <statemachinegroup.hpp>
+#include "../src/arduinostubs.hpp"
+
+namespace statemachinegroup_bench {
+
+const size_t MACHINES = 5000;
+
+// One self looping state per machine like a device session waiting for work
+struct Session {
+    uint32_t m_count = 0;
+    State m_state;
+    Session() {
+        m_state.setRunnable([this]() {
+            m_count++;
+            return &m_state;
+        });
+    }
+};
+
+void machinesInLoop(bench::Run& run) {
+    std::vector<std::unique_ptr<Session>> sessions;
+    std::vector<std::unique_ptr<StateMachine>> machines;
+
+    for (size_t i = 0; i < MACHINES; i++) {
+        sessions.emplace_back(new Session);
+        machines.emplace_back(new StateMachine(&sessions.back()->m_state));
+        machines.back()->start();
+    }
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i += MACHINES) {
+        for (auto& machine : machines) {
+            machine->handle();
+        }
+    }
+
+    bench::doNotOptimize(sessions.front()->m_count);
+}
+
+void machinesInGroup(bench::Run& run) {
+    std::vector<std::unique_ptr<Session>> sessions;
+    StateMachineGroup group{MACHINES};
+
+    for (size_t i = 0; i < MACHINES; i++) {
+        sessions.emplace_back(new Session);
+        group.add(&sessions.back()->m_state);
+    }
+
+    group.start();
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i += MACHINES) {
+        group.handle();
+    }
+
+    bench::doNotOptimize(sessions.front()->m_count);
+}
+
+const size_t WAITING_MACHINES = 100000;
+
+// Machines that mostly wait, each waits 60 seconds and then loops back
+struct Waiting {
+    StateTimed m_wait;
+    State m_work;
+    Waiting(uint32_t p_forTime) : m_wait(p_forTime) {
+        m_wait.setRunnable([this]() {
+            return &m_work;
+        });
+        m_work.setRunnable([this]() {
+            return &m_wait;
+        });
+    }
+};
+
+void waitingInLoop(bench::Run& run) {
+    std::vector<std::unique_ptr<Waiting>> sessions;
+    std::vector<std::unique_ptr<StateMachine>> machines;
+    millisStubbed = 0;
+
+    for (size_t i = 0; i < WAITING_MACHINES; i++) {
+        sessions.emplace_back(new Waiting(60000 + i % 1000));
+        machines.emplace_back(new StateMachine(&sessions.back()->m_wait));
+        machines.back()->start();
+    }
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        millisStubbed++;
+
+        for (auto& machine : machines) {
+            machine->handle();
+        }
+    }
+}
+
+void waitingInGroup(bench::Run& run) {
+    std::vector<std::unique_ptr<Waiting>> sessions;
+    StateMachineGroup group{WAITING_MACHINES};
+    millisStubbed = 0;
+
+    for (size_t i = 0; i < WAITING_MACHINES; i++) {
+        sessions.emplace_back(new Waiting(60000 + i % 1000));
+        group.add(&sessions.back()->m_wait);
+    }
+
+    group.start();
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        millisStubbed++;
+        group.handle();
+    }
+}
+
+BENCHMARK("StateMachine: 5000 machines handle() in a loop, per machine tick", machinesInLoop);
+BENCHMARK("StateMachineGroup: 5000 machines, per machine tick", machinesInGroup);
+BENCHMARK("StateMachine: 100000 waiting machines handle() in a loop, per 1ms tick", waitingInLoop);
+BENCHMARK("StateMachineGroup: 100000 waiting machines, per 1ms tick", waitingInGroup);
+
+}
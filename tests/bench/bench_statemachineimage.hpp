@@ -0,0 +1,69 @@
+#include "benchmark.hpp"
+
+#include <string>
+#include <statemachineimage.hpp>
+
+/**
+ * Device sessions described in JSON. Compiling the description is done once, starting from the
+ * compiled image loads it in place and puts every machine in its initial state, one op per machine.
+ */
+namespace statemachineimage_bench {
+
+const char* DESCRIPTION = R"({
+    "initial": "idle",
+    "states": [
+        {"name": "idle", "on": [{"event": 1, "to": "connecting", "action": "connect"}]},
+        {"name": "connecting", "timeout": {"after": 5000, "to": "failed"},
+         "on": [{"event": 2, "to": "connected", "guard": "linkUp"}, {"event": 3, "to": "failed"}]},
+        {"name": "connected", "on": [{"event": 3, "to": "idle"}, {"event": 4, "to": "updating"}]},
+        {"name": "updating", "timeout": {"after": 60000, "to": "failed"}, "on": [{"event": 5, "to": "connected"}]},
+        {"name": "failed", "timeout": {"after": 1000, "to": "idle"}}
+    ]
+})";
+
+StateMachineCallbacks callbacks() {
+    StateMachineCallbacks callbacks;
+    callbacks.guard("linkUp", [](const StateMachineInstance&) {
+        return true;
+    });
+    callbacks.action("connect", [](const StateMachineInstance&) {
+    });
+    return callbacks;
+}
+
+void compileDescription(bench::Run& run) {
+    std::vector<uint8_t> image;
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        StateMachineImage::compile(DESCRIPTION, image);
+        bench::doNotOptimize(image);
+    }
+}
+
+void startFromImage(bench::Run& run, const size_t p_machines) {
+    std::vector<uint8_t> image;
+    StateMachineImage::compile(DESCRIPTION, image);
+    const StateMachineCallbacks registered = callbacks();
+    std::vector<StateMachineInstance> sessions(p_machines);
+    run.setBytesPerMachine(sizeof(StateMachineInstance));
+
+    run.start();
+
+    for (uint64_t done = 0; done < run.iterations; done += p_machines) {
+        StateMachineImage machine;
+        machine.load(image.data(), image.size(), registered);
+
+        for (StateMachineInstance& session : sessions) {
+            machine.start(session, 0);
+        }
+
+        bench::doNotOptimize(sessions.back());
+    }
+}
+
+BENCHMARK("StateMachineImage: compile a 5 state JSON description", compileDescription);
+BENCHMARK("StateMachineImage: load image and start machines, per machine", {1000, 100000}, startFromImage);
+
+}
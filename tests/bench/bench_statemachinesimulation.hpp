@@ -0,0 +1,43 @@
+#include "benchmark.hpp"
+
+#include <memory>
+#include <vector>
+#include <statemachinesimulation.hpp>
+
+/**
+ * A week of simulated time for a fleet of devices that report every 5 to 60 minutes, every op is one machine for one week
+ */
+namespace statemachinesimulation_bench {
+
+struct Device {
+    StateTimed m_report;
+
+    Device(const StateTime p_period) : m_report(p_period) {
+        m_report.setRunnable([this]() {
+            return &m_report;
+        });
+    }
+};
+
+void week(bench::Run& run, const size_t p_machines) {
+    const StateTime WEEK = 7UL * 24 * 3600 * 1000;
+    std::vector<std::unique_ptr<Device>> devices;
+    StateMachineGroup group{p_machines};
+
+    for (size_t i = 0; i < p_machines; i++) {
+        devices.emplace_back(new Device(300000 + (i * 7919) % 3300000));
+        group.add(&devices.back()->m_report);
+    }
+
+    StateMachineSimulation simulation{group};
+    simulation.start();
+    run.start();
+
+    for (uint64_t done = 0; done < run.iterations; done += p_machines) {
+        simulation.runFor(WEEK);
+    }
+}
+
+BENCHMARK("simulation: week of reporting devices", {1000, 100000}, week);
+
+}
@@ -0,0 +1,158 @@
+#include "benchmark.hpp"
+
+#include <statemachine.hpp>
+#include <staticstatemachine.hpp>
+
+namespace staticstatemachine_bench {
+
+struct Ping;
+struct Pong;
+typedef StaticStates<Ping, Pong> PingPong;
+
+struct Ping {
+    StaticStateId run(const uint32_t currentMillis) {
+        return PingPong::id<Pong>();
+    }
+};
+
+struct Pong {
+    StaticStateId run(const uint32_t currentMillis) {
+        return PingPong::id<Ping>();
+    }
+};
+
+struct TimedPing;
+struct TimedPong;
+typedef StaticStates<TimedPing, TimedPong> TimedPingPong;
+
+struct TimedPing : StaticStateTimed<TimedPing, TimedPingPong> {
+    TimedPing() : StaticStateTimed(0) {
+    }
+    StaticStateId expired(const StateTime currentMillis) {
+        return TimedPingPong::id<TimedPong>();
+    }
+};
+
+struct TimedPong : StaticStateTimed<TimedPong, TimedPingPong> {
+    TimedPong() : StaticStateTimed(0) {
+    }
+    StaticStateId expired(const StateTime currentMillis) {
+        return TimedPingPong::id<TimedPing>();
+    }
+};
+
+struct Loop {
+    uint32_t m_count = 0;
+    StaticStateId run(const uint32_t currentMillis) {
+        m_count++;
+        return 0;
+    }
+};
+
+void stateSelfLoop(bench::Run& run) {
+    uint32_t count = 0;
+    State loop;
+    loop.setRunnable([&loop, &count]() {
+        count++;
+        return &loop;
+    });
+    StateMachine machine{&loop};
+    machine.start();
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        machine.handle();
+        bench::doNotOptimize(machine);
+    }
+
+    bench::doNotOptimize(count);
+}
+
+void stateTransition(bench::Run& run) {
+    State ping;
+    State pong;
+    ping.setRunnable([&pong]() {
+        return &pong;
+    });
+    pong.setRunnable([&ping]() {
+        return &ping;
+    });
+    StateMachine machine{&ping};
+    machine.start();
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        machine.handle();
+        bench::doNotOptimize(machine);
+    }
+}
+
+void staticSelfLoop(bench::Run& run) {
+    StaticStateMachine<Loop> machine;
+    machine.start();
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        machine.handle();
+        bench::doNotOptimize(machine);
+    }
+
+    bench::doNotOptimize(machine.state<Loop>().m_count);
+}
+
+void staticTransition(bench::Run& run) {
+    StaticStateMachine<PingPong> machine;
+    machine.start();
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        machine.handle();
+        bench::doNotOptimize(machine);
+    }
+}
+
+// Two StateTimed{0} that hand over to each other on every tick, a run and a transition with hooks each tick
+void stateTimedTransition(bench::Run& run) {
+    StateTimed ping{0};
+    StateTimed pong{0};
+    ping.setRunnable([&pong]() {
+        return &pong;
+    });
+    pong.setRunnable([&ping]() {
+        return &ping;
+    });
+    StateMachine machine{&ping};
+    machine.start(0);
+
+    run.start();
+
+    for (uint64_t i = 1; i <= run.iterations; i++) {
+        machine.handle(i);
+        bench::doNotOptimize(machine);
+    }
+}
+
+void staticTimedTransition(bench::Run& run) {
+    StaticStateMachine<TimedPingPong> machine;
+    machine.start(0);
+
+    run.start();
+
+    for (uint64_t i = 1; i <= run.iterations; i++) {
+        machine.handle(i);
+        bench::doNotOptimize(machine);
+    }
+}
+
+BENCHMARK("StateMachine: self looping State tick", stateSelfLoop);
+BENCHMARK("StaticStateMachine: self looping state tick", staticSelfLoop);
+BENCHMARK("StateMachine: State -> State transition", stateTransition);
+BENCHMARK("StaticStateMachine: state -> state transition", staticTransition);
+BENCHMARK("StateMachine: StateTimed -> StateTimed transition", stateTimedTransition);
+BENCHMARK("StaticStateMachine: StaticStateTimed -> StaticStateTimed transition", staticTimedTransition);
+
+}
@@ -0,0 +1,63 @@
+#include "benchmark.hpp"
+
+#include <thread>
+#include <vector>
+
+#include <statemachine.hpp>
+#include <transitionheatmap.hpp>
+
+namespace transitionheatmap_bench {
+
+void transitions(const uint64_t p_iterations, TransitionHeatMap* p_heatMap) {
+    State ping;
+    State pong;
+    ping.setRunnable([&pong]() {
+        return &pong;
+    });
+    pong.setRunnable([&ping]() {
+        return &ping;
+    });
+    StateMachine machine{&ping};
+    machine.setHeatMap(p_heatMap);
+    machine.start(0);
+
+    for (uint64_t i = 1; i <= p_iterations; i++) {
+        machine.handle(i);
+        bench::doNotOptimize(machine);
+    }
+}
+
+// The iterations are split over p_threads threads that each run their own machine, all counting in p_heatMap
+void threads(bench::Run& run, TransitionHeatMap* p_heatMap, const size_t p_threads) {
+    std::vector<std::thread> threads;
+
+    run.start();
+
+    for (size_t i = 0; i < p_threads; i++) {
+        threads.emplace_back(transitions, run.iterations / p_threads, p_heatMap);
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+BENCHMARK("StateMachine: transition, heat map compiled in but not attached", [](bench::Run& run) {
+    run.start();
+    transitions(run.iterations, nullptr);
+});
+BENCHMARK("StateMachine: transition, counting in a heat map", [](bench::Run& run) {
+    TransitionHeatMap heatMap;
+    run.start();
+    transitions(run.iterations, &heatMap);
+});
+BENCHMARK("StateMachine: transition, 4 threads, heat map shard per thread", [](bench::Run& run) {
+    TransitionHeatMap heatMap{256, 16};
+    threads(run, &heatMap, 4);
+});
+BENCHMARK("StateMachine: transition, 4 threads, one shared heat map shard", [](bench::Run& run) {
+    TransitionHeatMap heatMap{256, 1};
+    threads(run, &heatMap, 4);
+});
+
+}
@@ -0,0 +1,153 @@
+#include "benchmark.hpp"
+
+#include <memory>
+#include <random>
+#include <statemachine.hpp>
+#include <statictransitiontable.hpp>
+#include <transitiontable.hpp>
+
+namespace transitiontable_bench {
+
+const EventId EVENTS = 64;
+const size_t REACTIONS = STATEMACHINE_MAX_EVENTS;
+const size_t STREAM = 4096;
+
+/**
+ * States that react to REACTIONS of EVENTS events each, once with StateEvents and once through a TransitionTable.
+ * The event stream mixes events the current state reacts to with random events it ignores.
+ */
+struct Machine {
+    std::vector<std::unique_ptr<StateEvents<>>> m_states;
+    std::vector<std::unique_ptr<StateIdle>> m_tableStates;
+    TransitionTable m_table;
+    std::vector<EventId> m_stream;
+
+    Machine(const size_t p_states, const TransitionTable::Format p_format) {
+        std::mt19937 random{42};
+        std::vector<std::vector<std::pair<EventId, size_t>>> reactions(p_states);
+
+        for (size_t i = 0; i < p_states; i++) {
+            m_states.emplace_back(new StateEvents<>);
+            m_tableStates.emplace_back(new StateIdle);
+        }
+
+        for (size_t i = 0; i < p_states; i++) {
+            for (size_t r = 0; r < REACTIONS; r++) {
+                const EventId event = (i * 7 + r * (EVENTS / REACTIONS)) % EVENTS;
+                const size_t to = random() % p_states;
+                StateEvents<>* target = m_states[to].get();
+                m_states[i]->on(event, [target]() {
+                    return target;
+                });
+                m_table.on(m_tableStates[i].get(), event, m_tableStates[to].get());
+                reactions[i].push_back(std::make_pair(event, to));
+            }
+        }
+
+        m_table.build(p_format);
+
+        size_t current = 0;
+
+        for (size_t i = 0; i < STREAM; i++) {
+            if (random() % 2 == 0) {
+                const std::pair<EventId, size_t>& reaction = reactions[current][random() % REACTIONS];
+                m_stream.push_back(reaction.first);
+                current = reaction.second;
+            } else {
+                const EventId event = random() % EVENTS;
+                m_stream.push_back(event);
+
+                for (const std::pair<EventId, size_t>& reaction : reactions[current]) {
+                    if (reaction.first == event) {
+                        current = reaction.second;
+                    }
+                }
+            }
+        }
+    }
+};
+
+void dispatch(bench::Run& run, StateMachine& machine, const std::vector<EventId>& stream) {
+    machine.start();
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        machine.dispatch(stream[i % STREAM], 0);
+        bench::doNotOptimize(machine);
+    }
+}
+
+void reactDispatch(bench::Run& run, const size_t states) {
+    Machine setup{states, TransitionTable::FORMAT_AUTO};
+    StateMachine machine{setup.m_states[0].get()};
+    dispatch(run, machine, setup.m_stream);
+}
+
+void tableDispatch(bench::Run& run, const size_t states, const TransitionTable::Format format) {
+    Machine setup{states, format};
+    StateMachine machine{setup.m_tableStates[0].get()};
+    machine.setTransitionTable(&setup.m_table);
+    run.setBytesPerMachine(setup.m_table.memory());
+    dispatch(run, machine, setup.m_stream);
+}
+
+void denseDispatch(bench::Run& run, const size_t states) {
+    tableDispatch(run, states, TransitionTable::FORMAT_DENSE);
+}
+
+void sparseDispatch(bench::Run& run, const size_t states) {
+    tableDispatch(run, states, TransitionTable::FORMAT_SPARSE);
+}
+
+enum : StaticStateId { IDLE, RUNNING, PAUSED, STATES };
+enum : EventId { START, STOP, PAUSE };
+
+typedef StaticTransitionTable<STATES, IDLE,
+        StaticOn<IDLE, START, RUNNING>,
+        StaticOn<RUNNING, STOP, IDLE>,
+        StaticOn<RUNNING, PAUSE, PAUSED>,
+        StaticOn<PAUSED, START, RUNNING>> Motor;
+
+const EventId MOTOR_EVENTS[] = {START, PAUSE, STOP, START, STOP, PAUSE, START, STOP};
+
+void staticDispatch(bench::Run& run) {
+    StaticTransitionMachine<Motor> machine;
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        machine.dispatch(MOTOR_EVENTS[i % 8]);
+        bench::doNotOptimize(machine);
+    }
+}
+
+void tableMotorDispatch(bench::Run& run) {
+    StateIdle idle;
+    StateIdle running;
+    StateIdle paused;
+    TransitionTable table;
+    table.on(&idle, START, &running);
+    table.on(&running, STOP, &idle);
+    table.on(&running, PAUSE, &paused);
+    table.on(&paused, START, &running);
+    table.build();
+    StateMachine machine{&idle};
+    machine.setTransitionTable(&table);
+    machine.start();
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        machine.dispatch(MOTOR_EVENTS[i % 8], 0);
+        bench::doNotOptimize(machine);
+    }
+}
+
+BENCHMARK("StateMachine: dispatch() to StateEvents, states", {8, 1000}, reactDispatch);
+BENCHMARK("StateMachine: dispatch() through a dense TransitionTable, states", {8, 1000}, denseDispatch);
+BENCHMARK("StateMachine: dispatch() through a sparse TransitionTable, states", {8, 1000}, sparseDispatch);
+BENCHMARK("StateMachine: dispatch() through a TransitionTable, 3 states", tableMotorDispatch);
+BENCHMARK("StaticTransitionMachine: dispatch(), 3 states", staticDispatch);
+
+}
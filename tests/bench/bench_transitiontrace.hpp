@@ -0,0 +1,37 @@
+#include "benchmark.hpp"
+
+#include <statemachine.hpp>
+#include <transitiontrace.hpp>
+
+namespace transitiontrace_bench {
+
+void transition(bench::Run& run, TransitionTrace* p_trace) {
+    State ping;
+    State pong;
+    ping.setRunnable([&pong]() {
+        return &pong;
+    });
+    pong.setRunnable([&ping]() {
+        return &ping;
+    });
+    StateMachine machine{&ping};
+    machine.setTrace(p_trace);
+    machine.start();
+
+    run.start();
+
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        machine.handle();
+        bench::doNotOptimize(machine);
+    }
+}
+
+BENCHMARK("StateMachine: State -> State transition, trace compiled in but not attached", [](bench::Run& run) {
+    transition(run, nullptr);
+});
+BENCHMARK("StateMachine: State -> State transition, recording to a trace", [](bench::Run& run) {
+    TransitionTrace trace{1024};
+    transition(run, &trace);
+});
+
+}
@@ -0,0 +1,337 @@
+#pragma once
+#include <stdint.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Minimal benchmark runner, each benchmark gets a number of iterations to run
+ * and is repeated with more iterations until it runs long enough to be measured.
+ * Results are printed as a table, or as JSON with --json so they can be compared between releases.
+ * On Linux the instructions and L1 data cache misses per op are counted as well when perf events are allowed.
+ *
+ * Usage: bench [--json [file.json]] [filter]
+ */
+namespace bench {
+
+typedef std::chrono::steady_clock TClock;
+
+/**
+ * Counts a hardware event of this thread in user space, stop() returns 0 when not available
+ */
+class PerfCounter {
+    int m_fd;
+
+public:
+    enum Event {
+        INSTRUCTIONS,
+        L1D_READ_MISSES
+    };
+
+    explicit PerfCounter(const Event p_event) : m_fd(-1) {
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = p_event == INSTRUCTIONS ? PERF_TYPE_HARDWARE : PERF_TYPE_HW_CACHE;
+        attr.size = sizeof(attr);
+        attr.config = p_event == INSTRUCTIONS ? PERF_COUNT_HW_INSTRUCTIONS :
+                      PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    ~PerfCounter() {
+#ifdef __linux__
+        if (m_fd >= 0) {
+            close(m_fd);
+        }
+#endif
+    }
+
+    bool available() const {
+        return m_fd >= 0;
+    }
+
+    void start() {
+#ifdef __linux__
+        if (m_fd >= 0) {
+            ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    uint64_t stop() {
+        uint64_t count = 0;
+#ifdef __linux__
+        if (m_fd >= 0) {
+            ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+
+            if (read(m_fd, &count, sizeof(count)) != sizeof(count)) {
+                count = 0;
+            }
+        }
+#endif
+        return count;
+    }
+};
+
+/**
+ * Passed to every benchmark. Call start() after setting up, only the time after it is measured.
+ */
+class Run {
+    TClock::time_point m_start;
+    bool m_started;
+    double m_bytesPerMachine;
+    PerfCounter* m_instructions;
+    PerfCounter* m_misses;
+
+public:
+    const uint64_t iterations;
+
+    Run(const uint64_t p_iterations, PerfCounter* p_instructions = nullptr, PerfCounter* p_misses = nullptr) :
+        m_started(false),
+        m_bytesPerMachine(0),
+        m_instructions(p_instructions),
+        m_misses(p_misses),
+        iterations(p_iterations) {
+    }
+
+    // Reports the memory one machine takes, shown next to the time
+    void setBytesPerMachine(const double p_bytes) {
+        m_bytesPerMachine = p_bytes;
+    }
+
+    double bytesPerMachine() const {
+        return m_bytesPerMachine;
+    }
+
+    void start() {
+        m_started = true;
+
+        if (m_instructions != nullptr) {
+            m_instructions->start();
+        }
+
+        if (m_misses != nullptr) {
+            m_misses->start();
+        }
+
+        m_start = TClock::now();
+    }
+
+    bool started() const {
+        return m_started;
+    }
+
+    TClock::time_point startTime() const {
+        return m_start;
+    }
+};
+
+typedef std::function<void(Run& run)> TBenchFunction;
+
+struct Case {
+    std::string name;
+    // Number of machines the benchmark runs with, 0 when not applicable
+    size_t machines;
+    TBenchFunction function;
+};
+
+struct Result {
+    const Case* benchmark;
+    uint64_t iterations;
+    double nsPerOp;
+    // 0 when the benchmark does not report memory
+    double bytesPerMachine;
+    // 0 when instructions can not be counted
+    double instructionsPerOp;
+    // Below 0 when cache misses can not be counted
+    double missesPerOp;
+};
+
+inline std::vector<Case>& registry() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+struct Register {
+    Register(const char* p_name, const TBenchFunction& p_function) {
+        registry().push_back({p_name, 0, p_function});
+    }
+
+    // Registers the benchmark once for every machine count, named name/count
+    Register(const char* p_name, const std::vector<size_t>& p_machines, const std::function<void(Run&, size_t)>& p_function) {
+        for (const size_t machines : p_machines) {
+            registry().push_back({std::string(p_name) + "/" + std::to_string(machines), machines, [p_function, machines](Run & run) {
+                p_function(run, machines);
+            }
+                                 });
+        }
+    }
+};
+
+// Machine counts from 1 up to 1M
+inline std::vector<size_t> machineCounts() {
+    return {1, 10, 100, 1000, 10000, 100000, 1000000};
+}
+
+// Prevent the compiler from optimizing away a value
+template<typename T>
+inline void doNotOptimize(T const& p_value) {
+    asm volatile("" : : "r,m"(p_value) : "memory");
+}
+
+// Runs p_function and returns the time it took, p_instructions and p_misses are set to the instructions and cache misses it took
+inline double measure(const TBenchFunction& p_function, Run& p_run, PerfCounter& p_counter, uint64_t& p_instructions,
+                      PerfCounter& p_missCounter, uint64_t& p_misses) {
+    p_counter.start();
+    p_missCounter.start();
+    const TClock::time_point start = TClock::now();
+    p_function(p_run);
+    const TClock::time_point end = TClock::now();
+    p_misses = p_missCounter.stop();
+    p_instructions = p_counter.stop();
+    return std::chrono::duration<double, std::nano>(end - (p_run.started() ? p_run.startTime() : start)).count();
+}
+
+inline Result run(const Case& p_case) {
+    const double minTime = 100e6;
+    PerfCounter counter{PerfCounter::INSTRUCTIONS};
+    PerfCounter missCounter{PerfCounter::L1D_READ_MISSES};
+    uint64_t instructions = 0;
+    uint64_t misses = 0;
+    uint64_t iterations = p_case.machines == 0 ? 1 : p_case.machines;
+    Run first{iterations, &counter, &missCounter};
+    double elapsed = measure(p_case.function, first, counter, instructions, missCounter, misses);
+    double bytesPerMachine = first.bytesPerMachine();
+
+    while (elapsed < minTime && iterations < (1ULL << 40)) {
+        iterations = elapsed < minTime / 100 ? iterations * 10 : (uint64_t)(iterations * minTime * 1.2 / elapsed) + 1;
+        Run next{iterations, &counter, &missCounter};
+        elapsed = measure(p_case.function, next, counter, instructions, missCounter, misses);
+        bytesPerMachine = next.bytesPerMachine();
+    }
+
+    return {&p_case, iterations, elapsed / iterations, bytesPerMachine, (double)instructions / iterations,
+            missCounter.available() ? (double)misses / iterations : -1};
+}
+
+inline void printJson(FILE* p_out, const std::vector<Result>& p_results) {
+    fprintf(p_out, "{\n  \"context\": {\"compiler\": \"%s\", \"cplusplus\": %ld},\n  \"benchmarks\": [", __VERSION__, (long)__cplusplus);
+
+    for (size_t i = 0; i < p_results.size(); i++) {
+        const Result& result = p_results[i];
+        fprintf(p_out, "%s\n    {\"name\": \"%s\", \"machines\": %zu, \"iterations\": %llu, \"ns_per_op\": %.3f, \"ops_per_second\": %.0f",
+                i == 0 ? "" : ",",
+                result.benchmark->name.c_str(),
+                result.benchmark->machines,
+                (unsigned long long)result.iterations,
+                result.nsPerOp,
+                1e9 / result.nsPerOp);
+
+        if (result.bytesPerMachine != 0) {
+            fprintf(p_out, ", \"bytes_per_machine\": %.1f", result.bytesPerMachine);
+        }
+
+        if (result.instructionsPerOp != 0) {
+            fprintf(p_out, ", \"instructions_per_op\": %.1f", result.instructionsPerOp);
+        }
+
+        if (result.missesPerOp >= 0) {
+            fprintf(p_out, ", \"l1d_misses_per_op\": %.3f", result.missesPerOp);
+        }
+
+        fprintf(p_out, "}");
+    }
+
+    fprintf(p_out, "\n  ]\n}\n");
+}
+
+inline int runAll(int argc, char** argv) {
+    const char* filter = nullptr;
+    bool json = false;
+    const char* jsonFile = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+
+            if (i + 1 < argc && strstr(argv[i + 1], ".json") != nullptr) {
+                jsonFile = argv[++i];
+            }
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    std::vector<Result> results;
+
+    for (const Case& c : registry()) {
+        if (filter != nullptr && strstr(c.name.c_str(), filter) == nullptr) {
+            continue;
+        }
+
+        results.push_back(run(c));
+
+        // The table goes to stdout unless stdout has the JSON
+        if (!json || jsonFile != nullptr) {
+            const Result& result = results.back();
+            printf("%-70s %12.2f ns/op %16.0f ops/s", c.name.c_str(), result.nsPerOp, 1e9 / result.nsPerOp);
+
+            if (result.instructionsPerOp != 0) {
+                printf(" %10.1f instr/op", result.instructionsPerOp);
+            }
+
+            if (result.missesPerOp >= 0) {
+                printf(" %8.3f L1d misses/op", result.missesPerOp);
+            }
+
+            if (result.bytesPerMachine != 0) {
+                printf(" %10.1f bytes/machine", result.bytesPerMachine);
+            }
+
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+
+    if (json) {
+        FILE* out = jsonFile != nullptr ? fopen(jsonFile, "w") : stdout;
+
+        if (out == nullptr) {
+            perror(jsonFile);
+            return 1;
+        }
+
+        printJson(out, results);
+
+        if (out != stdout) {
+            fclose(out);
+        }
+    }
+
+    return 0;
+}
+
+}
+
+#define BENCH_CONCAT2(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT2(a, b)
+#define BENCHMARK(...) static bench::Register BENCH_CONCAT(benchRegister, __COUNTER__)(__VA_ARGS__)
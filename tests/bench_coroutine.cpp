@@ -0,0 +1,9 @@
+// Benchmarks that need C++20 coroutines
+#include "bench/benchmark.hpp"
+#include "bench/bench_statecoroutine.hpp"
+
+#include "src/arduinostubs.hpp"
+
+int main(int argc, char** argv) {
+    return bench::runAll(argc, argv);
+}
@@ -0,0 +1,9 @@
+// Benchmarks that need STATEMACHINE_HEATMAP, compare with the same benchmarks in bench
+#include "bench/benchmark.hpp"
+#include "bench/bench_transitionheatmap.hpp"
+
+#include "src/arduinostubs.hpp"
+
+int main(int argc, char** argv) {
+    return bench::runAll(argc, argv);
+}
@@ -0,0 +1,7 @@
+// Tests that need C++20 coroutines
+
+// Let Catch provide main():
+#define CATCH_CONFIG_MAIN
+
+#include "catch2/catch.hpp"
+#include "src/test_statecoroutine.hpp"
@@ -5,3 +5,22 @@
 
 #include "catch2/catch.hpp"
 #include "src/test_statemachine.hpp"
+#include "src/test_staticstatemachine.hpp"
+#include "src/test_inplacefunction.hpp"
+#include "src/test_statemachinegroup.hpp"
+#include "src/test_timerwheel.hpp"
+#include "src/test_eventqueue.hpp"
+#include "src/test_statemachineexecutor.hpp"
+#include "src/test_transitiontrace.hpp"
+#include "src/test_stateprofile.hpp"
+#include "src/test_statemachinedefinition.hpp"
+#include "src/test_indexedstatemachine.hpp"
+#include "src/test_statearena.hpp"
+#include "src/test_statemachineclock.hpp"
+#include "src/test_statemachinesimulation.hpp"
+#include "src/test_transitiontable.hpp"
+#include "src/test_statictransitiontable.hpp"
+#include "src/test_statemachineimage.hpp"
+#include "src/test_statemachinegen.hpp"
+#include "src/test_transitionheatmap.hpp"
+#include "src/test_statelayout.hpp"
@@ -0,0 +1,30 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifndef ALLOCATIONCOUNTER
+#define ALLOCATIONCOUNTER
+// Counts calls to the global operator new so tests can verify code does not allocate, atomic as threaded tests allocate too
+std::atomic<size_t> allocationCount{0};
+
+void* operator new(size_t p_size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(p_size == 0 ? 1 : p_size);
+
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+#endif
@@ -7,4 +7,8 @@ uint32_t millisStubbed = 0;
 extern "C" uint32_t millis() {
     return millisStubbed;
 };
+uint32_t microsStubbed = 0;
+extern "C" uint32_t micros() {
+    return microsStubbed;
+};
 #endif
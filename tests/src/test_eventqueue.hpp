@@ -0,0 +1,164 @@
+#include <catch2/catch.hpp>
+
+#include <thread>
+#include <vector>
+#include <statemachine.hpp>
+#include <eventqueue.hpp>
+#include "arduinostubs.hpp"
+
+TEST_CASE("Should queue events in order until full", "[eventqueue]") {
+    EventQueue queue{3};
+    EventId event = 0;
+
+    REQUIRE(queue.capacity() == 4);
+    REQUIRE(queue.pop(event) == false);
+
+    for (EventId i = 1; i <= 4; i++) {
+        REQUIRE(queue.push(i) == true);
+    }
+
+    REQUIRE(queue.push(5) == false);
+
+    for (EventId i = 1; i <= 4; i++) {
+        REQUIRE(queue.pop(event) == true);
+        REQUIRE(event == i);
+    }
+
+    REQUIRE(queue.pop(event) == false);
+    REQUIRE(queue.push(6) == true);
+    REQUIRE(queue.pop(event) == true);
+    REQUIRE(event == 6);
+}
+
+TEST_CASE("Should dispatch queued events on handle", "[eventqueue]") {
+    const EventId CONNECTED = 1;
+    StateEvents<> waitingState;
+    State connectedState;
+    waitingState.on(CONNECTED, [&connectedState]() {
+        return &connectedState;
+    });
+
+    EventQueue queue{8};
+    StateMachine machine {&waitingState};
+    machine.setEventQueue(&queue);
+    machine.start();
+
+    queue.push(CONNECTED);
+    REQUIRE(machine.current(&waitingState) == true);
+    machine.handle();
+    REQUIRE(machine.current(&connectedState) == true);
+}
+
+TEST_CASE("Should only dispatch the events queued when handle starts", "[eventqueue]") {
+    const EventId PING = 1;
+    uint32_t pings = 0;
+    uint32_t runs = 0;
+    EventQueue queue{8};
+    StateEvents<> pingState;
+    pingState.setRunnable([&pingState, &runs]() {
+        runs++;
+        return &pingState;
+    });
+    // Every event queues the next one
+    pingState.on(PING, [&pingState, &queue, &pings]() {
+        pings++;
+        queue.push(PING);
+        return &pingState;
+    });
+
+    StateMachine machine {&pingState};
+    machine.setEventQueue(&queue);
+    machine.start();
+
+    queue.push(PING);
+    queue.push(PING);
+    REQUIRE(queue.size() == 2);
+    machine.handle();
+    REQUIRE(pings == 2);
+    REQUIRE(runs == 1);
+    REQUIRE(queue.size() == 2);
+}
+
+namespace eventqueue_test {
+
+const EventId PRODUCERS = 4;
+// Events carry the producer in the low bits and its sequence number, modulo SEQUENCES, above it
+const uint32_t SEQUENCES = 4096;
+
+/**
+ * Checks in the consumer thread that the events of each producer arrive in the order they were pushed
+ */
+class SequenceState : public StateIdle {
+    uint32_t* m_received;
+    bool* m_ordered;
+
+    State* react(const EventId p_event, const StateTime p_currentTime) const override {
+        const EventId producer = p_event % PRODUCERS;
+        *m_ordered = *m_ordered && p_event / PRODUCERS == m_received[producer] % SEQUENCES;
+        m_received[producer]++;
+        return const_cast<SequenceState*>(this);
+    }
+
+public:
+    SequenceState(uint32_t* p_received, bool* p_ordered) :
+        m_received(p_received),
+        m_ordered(p_ordered) {
+    }
+};
+
+}
+
+TEST_CASE("Should deliver all events from many producer threads", "[eventqueue][threads]") {
+    using namespace eventqueue_test;
+    const uint32_t EVENTS = 50000;
+    uint32_t received[PRODUCERS] = {};
+    bool ordered = true;
+
+    SequenceState countingState{received, &ordered};
+    EventQueue queue{64};
+    StateMachine machine {&countingState};
+    machine.setEventQueue(&queue);
+    machine.start();
+
+    std::vector<std::thread> producers;
+
+    for (EventId producer = 0; producer < PRODUCERS; producer++) {
+        producers.emplace_back([&queue, producer, EVENTS]() {
+            for (uint32_t i = 0; i < EVENTS; i++) {
+                while (!queue.push(producer + PRODUCERS * (i % SEQUENCES))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    uint32_t total = 0;
+
+    while (total < PRODUCERS * EVENTS) {
+        machine.handle();
+        const uint32_t previous = total;
+        total = 0;
+
+        for (EventId producer = 0; producer < PRODUCERS; producer++) {
+            total += received[producer];
+        }
+
+        if (total == previous) {
+            std::this_thread::yield();
+        }
+    }
+
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+
+    // Every event of a producer had the next sequence number of that producer
+    REQUIRE(ordered == true);
+
+    for (EventId producer = 0; producer < PRODUCERS; producer++) {
+        REQUIRE(received[producer] == EVENTS);
+    }
+
+    EventId event;
+    REQUIRE(queue.pop(event) == false);
+}
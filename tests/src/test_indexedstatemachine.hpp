@@ -0,0 +1,84 @@
+#include <catch2/catch.hpp>
+
+#include <indexedstatemachine.hpp>
+#include "arduinostubs.hpp"
+
+TEST_CASE("Should run an indexed machine through its states", "[indexedstatemachine]") {
+    millisStubbed = 0;
+    IndexedStateMachine<3> machine;
+    const auto firstState = machine.add();
+    const auto secondState = machine.addTimed(10);
+    const auto thirdState = machine.add();
+
+    machine.setRunnable(firstState, [secondState]() {
+        return secondState;
+    });
+    machine.setRunnable(secondState, [thirdState]() {
+        return thirdState;
+    });
+    machine.setRunnable(thirdState, [thirdState]() {
+        return thirdState;
+    });
+
+    machine.start();
+    // Should initially be at the first state
+    REQUIRE(machine.current(firstState) == true);
+
+    // then second state
+    machine.handle();
+    REQUIRE(machine.current(secondState) == true);
+
+    // Still at second state
+    machine.handle();
+    REQUIRE(machine.current(secondState) == true);
+
+    // should have been advanced to third state
+    millisStubbed = 11;
+    machine.handle();
+    REQUIRE(machine.current(thirdState) == true);
+}
+
+TEST_CASE("Should use compact state ids", "[indexedstatemachine]") {
+    REQUIRE(sizeof(IndexedStateMachine<3>::TStateId) == 1);
+    REQUIRE(sizeof(IndexedStateMachine<1000>::TStateId) == 2);
+
+    IndexedStateMachine<2> machine;
+    REQUIRE(machine.add() == 0);
+    REQUIRE(machine.addIdle() == 1);
+    REQUIRE(machine.add() == IndexedStateMachine<2>::NONE);
+    REQUIRE(machine.size() == 2);
+}
+
+TEST_CASE("Should report deadlines of an indexed machine", "[indexedstatemachine]") {
+    millisStubbed = 100;
+    IndexedStateMachine<3> machine;
+    const auto waiting = machine.addTimed(50);
+    const auto idle = machine.addIdle();
+    machine.setRunnable(waiting, [idle]() {
+        return idle;
+    });
+    machine.start();
+
+    StateTime deadline = 0;
+    REQUIRE(machine.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 151);
+
+    millisStubbed = 151;
+    machine.handle();
+    REQUIRE(machine.current() == idle);
+    REQUIRE(machine.nextDeadline(deadline) == false);
+
+    // A polling state is due at the time passed in
+    const auto polling = machine.add();
+    machine.setRunnable(polling, [polling]() {
+        return polling;
+    });
+    machine.setRunnable(waiting, [polling]() {
+        return polling;
+    });
+    machine.start(100);
+    machine.handle(200);
+    REQUIRE(machine.current() == polling);
+    REQUIRE(machine.nextDeadline(300, deadline) == true);
+    REQUIRE(deadline == 300);
+}
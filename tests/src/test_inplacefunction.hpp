@@ -0,0 +1,73 @@
+#include <catch2/catch.hpp>
+
+#include <statemachine.hpp>
+#include <inplacefunction.hpp>
+#include "arduinostubs.hpp"
+#include "allocationcounter.hpp"
+
+TEST_CASE("Should call, copy and reset an InplaceFunction", "[inplacefunction]") {
+    int calls = 0;
+    InplaceFunction<int(int)> add = [&calls](int value) {
+        calls++;
+        return value + 1;
+    };
+    InplaceFunction<int(int)> empty;
+
+    REQUIRE(static_cast<bool>(add) == true);
+    REQUIRE(static_cast<bool>(empty) == false);
+    REQUIRE(add(1) == 2);
+
+    empty = add;
+    REQUIRE(empty(2) == 3);
+    REQUIRE(calls == 2);
+
+    add = nullptr;
+    REQUIRE(static_cast<bool>(add) == false);
+    REQUIRE(empty(3) == 4);
+}
+
+TEST_CASE("Should destroy the captured values of an InplaceFunction", "[inplacefunction]") {
+    std::shared_ptr<int> value = std::make_shared<int>(1);
+    {
+        InplaceFunction<int()> get = [value]() {
+            return *value;
+        };
+        InplaceFunction<int()> copy = get;
+        REQUIRE(value.use_count() == 3);
+        REQUIRE(copy() == 1);
+    }
+    REQUIRE(value.use_count() == 1);
+}
+
+TEST_CASE("Should build a state machine without heap allocations", "[inplacefunction]") {
+    uint32_t counter = 0;
+    const size_t before = allocationCount;
+    {
+        State firstState;
+        StateTimed secondState{10};
+        State thirdState;
+        firstState.setRunnable([&secondState, &counter]() {
+            counter++;
+            return &secondState;
+        });
+        secondState.setRunnable([&thirdState, &counter, before]() {
+            counter += before;
+            return &thirdState;
+        });
+
+        StateMachine machine {&firstState};
+        machine.start();
+        machine.handle();
+        REQUIRE(machine.current(&secondState) == true);
+    }
+    REQUIRE(allocationCount == before);
+    REQUIRE(counter == 1);
+}
+
+TEST_CASE("State without runnable should stay in the same state", "[inplacefunction]") {
+    State firstState;
+    StateMachine machine {&firstState};
+    machine.start();
+    machine.handle();
+    REQUIRE(machine.current(&firstState) == true);
+}
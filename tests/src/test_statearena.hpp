@@ -0,0 +1,75 @@
+#include <catch2/catch.hpp>
+
+#include <statemachine.hpp>
+#include "allocationcounter.hpp"
+#include "arduinostubs.hpp"
+
+namespace statearena_test {
+
+// Counts how often it is destroyed
+class CountingState : public State {
+    uint32_t& m_destroyed;
+public:
+    CountingState(uint32_t& p_destroyed) : m_destroyed(p_destroyed) {
+    }
+    virtual ~CountingState() {
+        m_destroyed++;
+    }
+};
+
+}
+
+TEST_CASE("Should run a machine with states in an arena", "[statearena]") {
+    millisStubbed = 0;
+    const size_t before = allocationCount;
+    StateArena arena{StateArena::sizeFor<State, StateTimed, State>()};
+    auto firstState = arena.create<State>();
+    auto secondState = arena.create<StateTimed>(10);
+    auto thirdState = arena.create<State>();
+
+    // One allocation for all states, placed in the order they were created
+    REQUIRE(allocationCount == before + 1);
+    REQUIRE(arena.used() == arena.capacity());
+    REQUIRE((unsigned char*)secondState - (unsigned char*)firstState == StateArena::sizeOf<State>());
+    REQUIRE((unsigned char*)thirdState - (unsigned char*)secondState == StateArena::sizeOf<StateTimed>());
+
+    firstState->setRunnable([secondState]() {
+        return secondState;
+    });
+    secondState->setRunnable([thirdState]() {
+        return thirdState;
+    });
+
+    DeletingStateMachine machine{firstState, std::move(arena)};
+    REQUIRE(arena.capacity() == 0);
+    machine.start();
+    machine.handle();
+    REQUIRE(machine.current(secondState) == true);
+    millisStubbed = 11;
+    machine.handle();
+    REQUIRE(machine.current(thirdState) == true);
+}
+
+TEST_CASE("Should destroy all states in an arena", "[statearena]") {
+    using namespace statearena_test;
+    uint32_t destroyed = 0;
+
+    {
+        StateArena arena{StateArena::sizeFor<CountingState, CountingState>()};
+        auto first = arena.create<CountingState>(destroyed);
+        REQUIRE(arena.create<CountingState>(destroyed) != nullptr);
+        // Full
+        REQUIRE(arena.create<CountingState>(destroyed) == nullptr);
+        DeletingStateMachine machine{first, std::move(arena)};
+        REQUIRE(destroyed == 0);
+    }
+
+    REQUIRE(destroyed == 2);
+
+    StateArena arena{StateArena::sizeFor<CountingState>()};
+    arena.create<CountingState>(destroyed);
+    arena.clear();
+    REQUIRE(destroyed == 3);
+    REQUIRE(arena.used() == 0);
+    REQUIRE(arena.create<CountingState>(destroyed) != nullptr);
+}
@@ -0,0 +1,197 @@
+#include <catch2/catch.hpp>
+
+#include <stdexcept>
+#include <statecoroutine.hpp>
+#include <statemachinegroup.hpp>
+#include "allocationcounter.hpp"
+#include "arduinostubs.hpp"
+
+namespace statecoroutine_test {
+const EventId CONNECTED = 1;
+const EventId DISCONNECTED = 2;
+}
+
+TEST_CASE("Should wait for a delay in a coroutine", "[statecoroutine]") {
+    millisStubbed = 0;
+    StateCoroutinePool pool{256, 2};
+    uint32_t attempts = 0;
+    State doneState;
+    StateCoroutine connect{pool, [&attempts, &doneState](StateCoroutine & self) -> StateTask {
+        while (++attempts < 3) {
+            co_await self.delay(100);
+        }
+
+        co_return &doneState;
+    }};
+
+    StateMachine machine{&connect};
+    machine.start();
+    machine.handle();
+    REQUIRE(attempts == 1);
+
+    StateTime deadline = 0;
+    REQUIRE(machine.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 101);
+
+    millisStubbed = 100;
+    machine.handle();
+    REQUIRE(attempts == 1);
+
+    millisStubbed = 101;
+    machine.handle();
+    REQUIRE(attempts == 2);
+    REQUIRE(machine.current(&connect) == true);
+
+    millisStubbed = 202;
+    machine.handle();
+    REQUIRE(attempts == 3);
+    REQUIRE(machine.current(&doneState) == true);
+    REQUIRE(pool.failures() == 0);
+}
+
+TEST_CASE("Should wait for events in a coroutine", "[statecoroutine]") {
+    using namespace statecoroutine_test;
+    StateCoroutinePool pool{256, 1};
+    uint32_t timeouts = 0;
+    uint32_t sessions = 0;
+    StateCoroutine session{pool, [&](StateCoroutine & self) -> StateTask {
+        while (!co_await self.event(CONNECTED, 1000)) {
+            timeouts++;
+        }
+
+        sessions++;
+        co_await self.event(DISCONNECTED);
+        // Start over
+        co_return &self;
+    }};
+
+    StateMachineGroup group;
+    const size_t machine = group.add(&session);
+    group.start(0);
+    group.handle(0);
+
+    // Only the timeout of the event is handled
+    group.handle(1001);
+    REQUIRE(timeouts == 1);
+
+    const size_t before = allocationCount;
+    group.dispatch(machine, CONNECTED, 1500);
+    REQUIRE(sessions == 1);
+
+    // Sleeps until the event arrives
+    group.handle(5000);
+    REQUIRE(group.active() == 0);
+    StateTime deadline = 0;
+    REQUIRE(group.nextDeadline(5000, deadline) == false);
+
+    group.dispatch(machine, DISCONNECTED, 6000);
+    group.handle(6000);
+    group.handle(6000);
+    group.dispatch(machine, CONNECTED, 6500);
+    REQUIRE(sessions == 2);
+    REQUIRE(timeouts == 1);
+
+    // Frames come from the pool
+    REQUIRE(allocationCount == before);
+}
+
+TEST_CASE("Should park a coroutine in a group again when an event starts a delay", "[statecoroutine]") {
+    using namespace statecoroutine_test;
+    StateCoroutinePool pool{256, 2};
+    uint32_t delayed = 0;
+    uint32_t retried = 0;
+    StateCoroutine afterEvent{pool, [&delayed](StateCoroutine & self) -> StateTask {
+        co_await self.event(CONNECTED);
+        co_await self.delay(100);
+        delayed++;
+        co_await self.event(DISCONNECTED);
+        co_return &self;
+    }};
+    StateCoroutine afterTimeout{pool, [&retried](StateCoroutine & self) -> StateTask {
+        co_await self.event(CONNECTED, 1000);
+        co_await self.delay(50);
+        retried++;
+        co_await self.event(DISCONNECTED);
+        co_return &self;
+    }};
+
+    StateMachineGroup group;
+    const size_t first = group.add(&afterEvent);
+    const size_t second = group.add(&afterTimeout);
+    group.start(0);
+    group.handle(0);
+    REQUIRE(group.active() == 0);
+
+    // The event resumes the coroutines into a delay without a transition
+    group.dispatch(first, CONNECTED, 500);
+    group.dispatch(second, CONNECTED, 200);
+    StateTime deadline = 0;
+    REQUIRE(group.nextDeadline(500, deadline) == true);
+    REQUIRE(deadline == 251);
+
+    group.handle(251);
+    REQUIRE(retried == 1);
+    REQUIRE(delayed == 0);
+
+    group.handle(601);
+    REQUIRE(delayed == 1);
+    REQUIRE(group.active() == 0);
+}
+
+TEST_CASE("Should not allocate a frame when a coroutine function is called directly", "[statecoroutine]") {
+    StateCoroutinePool pool{256, 1};
+    auto function = [](StateCoroutine & self) -> StateTask {
+        co_return &self;
+    };
+    StateCoroutine coroutine{pool, function};
+
+    StateTask task = function(coroutine);
+    REQUIRE(!task.m_handle);
+}
+
+TEST_CASE("Should throw exceptions of a coroutine from handle", "[statecoroutine]") {
+    StateCoroutinePool pool{256, 1};
+    uint32_t attempts = 0;
+    StateCoroutine failing{pool, [&attempts](StateCoroutine & self) -> StateTask {
+        attempts++;
+        co_await self.delay(10);
+        throw std::runtime_error("failed");
+    }};
+
+    StateMachine machine{&failing};
+    machine.start(0);
+    machine.handle(0);
+    REQUIRE_THROWS_AS(machine.handle(11), std::runtime_error);
+    REQUIRE(attempts == 1);
+
+    // Starts over with the frame released
+    machine.handle(12);
+    REQUIRE(attempts == 2);
+    REQUIRE(pool.failures() == 0);
+}
+
+TEST_CASE("Should not start a coroutine without a free frame", "[statecoroutine]") {
+    StateCoroutinePool pool{256, 1};
+    State doneState;
+    StateCoroutine first{pool, [&doneState](StateCoroutine & self) -> StateTask {
+        co_await self.delay(1000);
+        co_return &doneState;
+    }};
+    StateCoroutine second{pool, [](StateCoroutine & self) -> StateTask {
+        co_return &self;
+    }};
+
+    StateMachine firstMachine{&first};
+    StateMachine secondMachine{&second};
+    firstMachine.start(0);
+    secondMachine.start(0);
+    firstMachine.handle(0);
+    secondMachine.handle(0);
+    REQUIRE(pool.failures() == 1);
+
+    // Frame is free again after the first finished
+    firstMachine.handle(1001);
+    REQUIRE(firstMachine.current(&doneState) == true);
+    secondMachine.handle(1001);
+    REQUIRE(pool.failures() == 1);
+}
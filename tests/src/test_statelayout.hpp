@@ -0,0 +1,148 @@
+#include <catch2/catch.hpp>
+
+#include <statelayout.hpp>
+#include <statemachine.hpp>
+#include <statemachinedefinition.hpp>
+#include <transitionheatmap.hpp>
+#include <transitiontable.hpp>
+#include "arduinostubs.hpp"
+
+TEST_CASE("Should chain states along the most taken transitions", "[statelayout]") {
+    const std::vector<StateLayoutEdge> edges{
+        {1, 2, 10},
+        {0, 3, 100},
+        {3, 5, 90},
+        // Would close the chain 0, 3, 5 into a loop
+        {5, 0, 80},
+        {2, 1, 5},
+        // Self loops and unknown states are left out
+        {4, 4, 1000},
+        {4, 9, 1000},
+    };
+
+    REQUIRE(stateLayout(6, edges) == std::vector<uint16_t>({0, 3, 5, 1, 2, 4}));
+    REQUIRE(stateLayout(3, {}) == std::vector<uint16_t>({0, 1, 2}));
+}
+
+TEST_CASE("Should count transitions in a layout profile", "[statelayout]") {
+    StateLayoutProfile profile;
+    profile.record(0, 1);
+    profile.record(1, 1);
+    profile.record(1, 0, 3);
+    profile.record(0, 1);
+
+    REQUIRE(profile.edges().size() == 2);
+    REQUIRE(profile.edges()[0].m_from == 0);
+    REQUIRE(profile.edges()[0].m_to == 1);
+    REQUIRE(profile.edges()[0].m_count == 2);
+    REQUIRE(profile.edges()[1].m_count == 3);
+
+    profile.clear();
+    REQUIRE(profile.edges().empty());
+}
+
+TEST_CASE("Should keep ids when freezing a definition with a profile", "[statelayout]") {
+    StateMachineDefinition definition;
+    std::vector<StateId> ids;
+
+    for (size_t i = 0; i < 5; i++) {
+        ids.push_back(definition.add());
+    }
+
+    // Runs through the states as 0, 3, 1, 4, 2
+    const std::vector<StateId> cycle{0, 3, 1, 4, 2};
+
+    for (size_t i = 0; i < cycle.size(); i++) {
+        const StateId next = cycle[(i + 1) % cycle.size()];
+        definition.setRunnable(cycle[i], [next](const StateMachineInstance&) {
+            return next;
+        });
+    }
+
+    definition.setName(4, "four");
+    REQUIRE(definition.layout() == std::vector<StateId>({0, 1, 2, 3, 4}));
+
+    StateLayoutProfile profile;
+    StateMachineInstance instance;
+    definition.start(instance, 0, 0);
+
+    for (StateTime i = 1; i <= 20; i++) {
+        const StateId before = instance.state();
+        definition.handle(instance, i);
+        profile.record(before, instance.state());
+    }
+
+    definition.freeze(profile.edges());
+    REQUIRE(definition.layout() == std::vector<StateId>({0, 3, 1, 4, 2}));
+    REQUIRE(definition.size() == 5);
+    REQUIRE(std::string(definition.name(4)) == "four");
+
+    // Instances run as before
+    for (size_t i = 0; i < 10; i++) {
+        REQUIRE(instance.state() == cycle[i % cycle.size()]);
+        definition.handle(instance, 100);
+    }
+
+    // States added after freezing go at the end
+    const StateId late = definition.addTimed(5);
+    REQUIRE(late == 5);
+    REQUIRE(definition.layout() == std::vector<StateId>({0, 3, 1, 4, 2, 5}));
+}
+
+TEST_CASE("Should renumber the states of a transition table by a heat map", "[statelayout]") {
+    const EventId GO = 0;
+    const EventId SKIP = 1;
+    StateIdle first;
+    StateIdle second;
+    StateIdle third;
+    TransitionTable table;
+    table.on(&first, GO, &second);
+    table.on(&second, GO, &third);
+    table.on(&third, GO, &first);
+    table.on(&first, SKIP, &third);
+
+    TransitionHeatMap heatMap;
+    heatMap.record(&first, &third, 0);
+    heatMap.record(&third, &first, 0);
+    heatMap.record(&first, &third, 0);
+    heatMap.record(&first, &second, 0);
+    table.build(TransitionTable::FORMAT_SPARSE, &heatMap);
+
+    REQUIRE(first.id() == 0);
+    REQUIRE(third.id() == 1);
+    REQUIRE(second.id() == 2);
+    REQUIRE(table.state(1) == &third);
+
+    StateMachine machine{&first};
+    machine.setTransitionTable(&table);
+    machine.start();
+    machine.dispatch(GO);
+    REQUIRE(machine.current(&second) == true);
+    machine.dispatch(GO);
+    REQUIRE(machine.current(&third) == true);
+    machine.dispatch(GO);
+    machine.dispatch(SKIP);
+    REQUIRE(machine.current(&third) == true);
+}
+
+TEST_CASE("Should ignore heat map states that are gone when renumbering", "[statelayout]") {
+    const EventId GO = 0;
+    StateIdle first;
+    StateIdle second;
+    TransitionTable table;
+    table.on(&first, GO, &second);
+    table.on(&second, GO, &first);
+
+    TransitionHeatMap heatMap;
+    heatMap.record(&second, &first, 0);
+    {
+        StateIdle gone;
+        heatMap.record(&gone, &second, 0);
+        heatMap.record(&first, &gone, 0);
+    }
+    table.build(TransitionTable::FORMAT_SPARSE, &heatMap);
+
+    REQUIRE(second.id() == 0);
+    REQUIRE(first.id() == 1);
+    REQUIRE(table.state(0) == &second);
+}
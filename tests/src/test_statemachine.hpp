@@ -1,6 +1,7 @@
 #include <catch2/catch.hpp>
 
 #include <statemachine.hpp>
+#include <statemachinesimulation.hpp>
 #include <iostream>
 #include "arduinostubs.hpp"
 
@@ -94,3 +95,173 @@ TEST_CASE("Should handle timed states", "[statemachine]") {
     machine.handle();
     REQUIRE(machine.current(thirdState) == true);
 }
+
+TEST_CASE("Should report when the machine needs to be handled next", "[statemachine]") {
+    millisStubbed = 100;
+    auto firstState = new State;
+    auto secondState = new StateTimed{10};
+    auto thirdState = new StateIdle;
+
+    firstState->setRunnable([secondState]() {
+        return secondState;
+    });
+    secondState->setRunnable([thirdState]() {
+        return thirdState;
+    });
+
+    StateMachine machine {firstState };
+    machine.start();
+    StateTime deadline = 0;
+
+    // A State can change at any time
+    REQUIRE(machine.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 100);
+
+    // A StateTimed can change once it's time has passed
+    machine.handle();
+    millisStubbed = 105;
+    REQUIRE(machine.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 111);
+
+    // Handling before the deadline does not change the deadline
+    machine.handle();
+    REQUIRE(machine.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 111);
+
+    // A StateIdle never changes on its own
+    millisStubbed = deadline;
+    machine.handle();
+    REQUIRE(machine.current(thirdState) == true);
+    REQUIRE(machine.nextDeadline(deadline) == false);
+}
+
+TEST_CASE("Should react to dispatched events", "[statemachine]") {
+    const EventId CONNECTED = 1;
+    const EventId DISCONNECTED = 2;
+    millisStubbed = 0;
+    auto connectingState = new StateEvents<StateTimed>{100};
+    auto connectedState = new StateEvents<>;
+    auto failedState = new State;
+
+    connectingState->setRunnable([failedState]() {
+        return failedState;
+    });
+    connectingState->on(CONNECTED, [connectedState]() {
+        return connectedState;
+    });
+    connectedState->on(DISCONNECTED, [connectingState]() {
+        return connectingState;
+    });
+
+    StateMachine machine {connectingState };
+    machine.start();
+    StateTime deadline = 0;
+
+    // Events the state does not react to are ignored
+    machine.dispatch(DISCONNECTED);
+    REQUIRE(machine.current(connectingState) == true);
+
+    machine.dispatch(CONNECTED);
+    REQUIRE(machine.current(connectedState) == true);
+    REQUIRE(machine.nextDeadline(deadline) == false);
+
+    // Waiting for an event does not change state
+    millisStubbed = 1000;
+    machine.handle();
+    REQUIRE(machine.current(connectedState) == true);
+
+    // Timer starts again when entering the state
+    machine.dispatch(DISCONNECTED);
+    REQUIRE(machine.current(connectingState) == true);
+    REQUIRE(machine.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 1101);
+
+    millisStubbed = 1101;
+    machine.handle();
+    REQUIRE(machine.current(failedState) == true);
+}
+
+TEST_CASE("Should fast forward timed states in a simulation", "[statemachine]") {
+    State firstState;
+    StateTimed secondState{3600000};
+    State thirdState;
+    firstState.setRunnable([&secondState]() {
+        return &secondState;
+    });
+    secondState.setRunnable([&thirdState]() {
+        return &thirdState;
+    });
+
+    StateMachineGroup group;
+    const size_t machine = group.add(&firstState);
+    StateMachineSimulation simulation{group};
+    simulation.start();
+    REQUIRE(group.current(machine, &secondState) == true);
+
+    simulation.runUntil(3600000);
+    REQUIRE(group.current(machine, &secondState) == true);
+
+    // An hour later in a few steps
+    simulation.runUntil(3600001);
+    REQUIRE(group.current(machine, &thirdState) == true);
+    REQUIRE(simulation.steps() == 2);
+}
+
+TEST_CASE("Should run to completion within one handle", "[statemachine]") {
+    millisStubbed = 0;
+    State firstState;
+    State secondState;
+    StateTimed thirdState{10};
+    State fourthState;
+    firstState.setRunnable([&secondState]() {
+        return &secondState;
+    });
+    secondState.setRunnable([&thirdState]() {
+        return &thirdState;
+    });
+    thirdState.setRunnable([&fourthState]() {
+        return &fourthState;
+    });
+
+    StateMachine machine{&firstState};
+    machine.setRunToCompletion(8);
+    machine.start();
+
+    // Stops once the timed state starts waiting
+    machine.handle();
+    REQUIRE(machine.current(&thirdState) == true);
+    REQUIRE(machine.hopLimitReached() == false);
+
+    millisStubbed = 11;
+    machine.handle();
+    REQUIRE(machine.current(&fourthState) == true);
+    REQUIRE(machine.hopLimitReached() == false);
+}
+
+TEST_CASE("Should stop a cycle of states at the hop limit", "[statemachine]") {
+    uint32_t runs = 0;
+    State ping;
+    State pong;
+    ping.setRunnable([&pong, &runs]() {
+        runs++;
+        return &pong;
+    });
+    pong.setRunnable([&ping, &runs]() {
+        runs++;
+        return &ping;
+    });
+
+    StateMachine machine{&ping};
+    machine.setRunToCompletion(5);
+    machine.start();
+    machine.handle();
+    REQUIRE(runs == 5);
+    REQUIRE(machine.current(&pong) == true);
+    REQUIRE(machine.hopLimitReached() == true);
+
+    // Default is one transition per handle
+    machine.setRunToCompletion(1);
+    machine.handle();
+    REQUIRE(runs == 6);
+    REQUIRE(machine.hopLimitReached() == false);
+}
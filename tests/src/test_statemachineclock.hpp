@@ -0,0 +1,135 @@
+#include <catch2/catch.hpp>
+
+#include <statemachine.hpp>
+#include <statemachinegroup.hpp>
+#include "arduinostubs.hpp"
+
+namespace statemachineclock_test {
+
+// Clock owned by the test instead of millisStubbed
+struct TestClock {
+    static StateTime time;
+    static StateTime now() {
+        return time;
+    }
+};
+
+StateTime TestClock::time = 0;
+
+}
+
+TEST_CASE("Should read the time from the clock policy", "[statemachineclock]") {
+    using namespace statemachineclock_test;
+    millisStubbed = 0;
+    TestClock::time = 1000;
+    StateTimed waitState{10};
+    State doneState;
+    waitState.setRunnable([&doneState]() {
+        return &doneState;
+    });
+
+    ClockedStateMachine<TestClock> machine{&waitState};
+    machine.start();
+
+    StateTime deadline = 0;
+    REQUIRE(machine.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 1011);
+
+    TestClock::time = 1010;
+    machine.handle();
+    REQUIRE(machine.current(&waitState) == true);
+
+    TestClock::time = 1011;
+    machine.handle();
+    REQUIRE(machine.current(&doneState) == true);
+}
+
+TEST_CASE("Should wait across the wrap of the time", "[statemachineclock]") {
+    const StateTime start = static_cast<StateTime>(~0) - 5;
+    StateTimed waitState{10};
+    State doneState;
+    waitState.setRunnable([&doneState]() {
+        return &doneState;
+    });
+
+    StateMachine machine{&waitState};
+    machine.start(start);
+    machine.handle(start + 10);
+    REQUIRE(machine.current(&waitState) == true);
+    machine.handle(start + 11);
+    REQUIRE(machine.current(&doneState) == true);
+}
+
+TEST_CASE("Should keep counting when millis() wraps with a 64 bit StateTime", "[statemachineclock]") {
+    if (sizeof(StateTime) < 8) {
+        return;
+    }
+
+    // The time has to be read at least every 2^31 ms to count the wraps, get there in two steps
+    millisStubbed = 0;
+    MillisClock::now();
+    millisStubbed = 0x7FFFFFFF;
+    MillisClock::now();
+    millisStubbed = 0xFFFFFF00;
+    StateTimed waitState{1000};
+    State doneState;
+    waitState.setRunnable([&doneState]() {
+        return &doneState;
+    });
+
+    StateMachine machine{&waitState};
+    machine.start();
+    const StateTime start = MillisClock::now();
+
+    millisStubbed += 512;
+    machine.handle();
+    REQUIRE(machine.current(&waitState) == true);
+    REQUIRE(MillisClock::now() - start == 512);
+
+    millisStubbed += 489;
+    machine.handle();
+    REQUIRE(machine.current(&doneState) == true);
+
+    // Go back in steps of less than 2^31 so the following tests get the times before the wrap again
+    millisStubbed = 0xFFFFFF00;
+    MillisClock::now();
+    millisStubbed = 0x80000000;
+    MillisClock::now();
+    millisStubbed = 0;
+    REQUIRE(start - MillisClock::now() == 0xFFFFFF00);
+}
+
+TEST_CASE("Should wait longer than 32 bits of time with a 64 bit StateTime", "[statemachineclock]") {
+    if (sizeof(StateTime) < 8) {
+        return;
+    }
+
+    // Five days in microseconds
+    const StateTime wait = static_cast<StateTime>(5) * 24 * 3600 * 1000000;
+    const StateTime start = 1000;
+    StateTimed waitState{wait};
+    State doneState;
+    waitState.setRunnable([&doneState]() {
+        return &doneState;
+    });
+
+    StateMachineGroup group;
+    const size_t machine = group.add(&waitState);
+    group.start(start);
+
+    StateTime deadline = 0;
+    group.handle(start);
+    REQUIRE(group.nextDeadline(deadline) == true);
+    REQUIRE(deadline == start + 0x7FFFFFFF);
+
+    // The wheel holds 31 bits, the machine is parked again until its real deadline
+    for (StateTime time = start; time < start + wait; time += 0x40000000) {
+        group.handle(time);
+        REQUIRE(group.current(machine, &waitState) == true);
+    }
+
+    group.handle(start + wait);
+    REQUIRE(group.current(machine, &waitState) == true);
+    group.handle(start + wait + 1);
+    REQUIRE(group.current(machine, &doneState) == true);
+}
@@ -0,0 +1,135 @@
+#include <catch2/catch.hpp>
+
+#include <thread>
+#include <vector>
+#include <statemachinedefinition.hpp>
+#include "arduinostubs.hpp"
+
+TEST_CASE("Should run instances of a shared definition independently", "[statemachinedefinition]") {
+    millisStubbed = 0;
+    StateMachineDefinition definition;
+    const StateId first = definition.add();
+    const StateId second = definition.addTimed(10);
+    const StateId third = definition.add();
+    definition.setRunnable(first, [second](const StateMachineInstance&) {
+        return second;
+    });
+    definition.setRunnable(second, [third](const StateMachineInstance&) {
+        return third;
+    });
+
+    REQUIRE(definition.size() == 3);
+
+    StateMachineInstance early;
+    StateMachineInstance late;
+    definition.start(early, first);
+    definition.start(late, first);
+
+    definition.handle(early);
+    REQUIRE(early.state() == second);
+    REQUIRE(late.state() == first);
+
+    millisStubbed = 5;
+    definition.handle(late);
+    REQUIRE(late.state() == second);
+    REQUIRE(late.startTime() == 5);
+
+    // Each instance waits from its own start time
+    millisStubbed = 11;
+    definition.handle(early);
+    definition.handle(late);
+    REQUIRE(early.state() == third);
+    REQUIRE(late.state() == second);
+
+    millisStubbed = 16;
+    definition.handle(late);
+    REQUIRE(late.state() == third);
+}
+
+TEST_CASE("Should pass the instance to the runnable", "[statemachinedefinition]") {
+    StateMachineDefinition definition;
+    const StateId waiting = definition.add();
+    const StateId done = definition.addIdle();
+    std::vector<StateMachineInstance> instances(4);
+    const StateMachineInstance* ready = &instances[2];
+    definition.setRunnable(waiting, [ready, waiting, done](const StateMachineInstance & p_instance) {
+        return &p_instance == ready ? done : waiting;
+    });
+
+    for (StateMachineInstance& instance : instances) {
+        definition.start(instance, waiting, 0);
+        definition.handle(instance, 1);
+    }
+
+    REQUIRE(instances[0].state() == waiting);
+    REQUIRE(instances[2].state() == done);
+}
+
+TEST_CASE("Should report deadlines of an instance", "[statemachinedefinition]") {
+    StateMachineDefinition definition;
+    const StateId polling = definition.add([](const StateMachineInstance&) {
+        return 1;
+    });
+    const StateId timed = definition.addTimed(100);
+    const StateId idle = definition.addIdle();
+    StateMachineInstance instance;
+    StateTime deadline = 0;
+
+    millisStubbed = 20;
+    definition.start(instance, polling);
+    REQUIRE(definition.nextDeadline(instance, deadline) == true);
+    REQUIRE(deadline == 20);
+    REQUIRE(definition.nextDeadline(instance, 25, deadline) == true);
+    REQUIRE(deadline == 25);
+
+    definition.handle(instance);
+    REQUIRE(instance.state() == timed);
+    REQUIRE(definition.nextDeadline(instance, deadline) == true);
+    REQUIRE(deadline == 121);
+
+    definition.start(instance, idle);
+    REQUIRE(definition.nextDeadline(instance, deadline) == false);
+}
+
+TEST_CASE("Should share one definition between threads", "[statemachinedefinition][threads]") {
+    StateMachineDefinition definition;
+    const StateId ping = definition.add();
+    const StateId pong = definition.addTimed(1);
+    definition.setRunnable(ping, [pong](const StateMachineInstance&) {
+        return pong;
+    });
+    definition.setRunnable(pong, [ping](const StateMachineInstance&) {
+        return ping;
+    });
+
+    const size_t THREADS = 4;
+    const uint32_t ROUNDS = 1000;
+    std::vector<std::vector<StateMachineInstance>> instances(THREADS, std::vector<StateMachineInstance>(100));
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < THREADS; t++) {
+        threads.emplace_back([&definition, &instances, t, ping]() {
+            for (StateMachineInstance& instance : instances[t]) {
+                definition.start(instance, ping, 0);
+            }
+
+            for (uint32_t time = 1; time <= ROUNDS; time++) {
+                for (StateMachineInstance& instance : instances[t]) {
+                    definition.handle(instance, time);
+                }
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // ping at 1, pong waits until 3, ping at 4 ... every instance went through the same states
+    for (size_t t = 0; t < THREADS; t++) {
+        for (const StateMachineInstance& instance : instances[t]) {
+            REQUIRE(instance.state() == instances[0][0].state());
+            REQUIRE(instance.startTime() == instances[0][0].startTime());
+        }
+    }
+}
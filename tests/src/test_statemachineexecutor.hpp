@@ -0,0 +1,71 @@
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <statemachineexecutor.hpp>
+#include "arduinostubs.hpp"
+
+namespace statemachineexecutor_test {
+
+// Counts its ticks and detects when two threads run it at the same time
+struct Counter {
+    std::atomic<bool> m_running{false};
+    bool m_overlap = false;
+    uint32_t m_ticks = 0;
+    uint32_t m_lastTime = 0;
+    State m_state;
+    StateMachine m_machine{&m_state};
+
+    Counter() {
+        m_state.setRunnable([this]() {
+            if (m_running.exchange(true)) {
+                m_overlap = true;
+            }
+
+            m_ticks++;
+            m_running = false;
+            return &m_state;
+        });
+    }
+};
+
+}
+
+TEST_CASE("Should handle every machine once per handle on all threads", "[statemachineexecutor][threads]") {
+    using namespace statemachineexecutor_test;
+    const size_t MACHINES = 1000;
+    const uint32_t ROUNDS = 50;
+    std::vector<std::unique_ptr<Counter>> counters;
+    StateMachineExecutor executor{4, 16};
+
+    for (size_t i = 0; i < MACHINES; i++) {
+        counters.emplace_back(new Counter);
+        executor.add(&counters.back()->m_machine);
+        counters.back()->m_machine.start();
+    }
+
+    REQUIRE(executor.size() == MACHINES);
+    REQUIRE(executor.threads() == 4);
+
+    for (uint32_t round = 0; round < ROUNDS; round++) {
+        executor.handle(round);
+    }
+
+    for (const auto& counter : counters) {
+        REQUIRE(counter->m_ticks == ROUNDS);
+        REQUIRE(counter->m_overlap == false);
+    }
+}
+
+TEST_CASE("Should handle machines without extra threads", "[statemachineexecutor]") {
+    using namespace statemachineexecutor_test;
+    Counter counter;
+    StateMachineExecutor executor{1};
+    executor.add(&counter.m_machine);
+    counter.m_machine.start();
+
+    executor.handle();
+    executor.handle();
+    REQUIRE(counter.m_ticks == 2);
+}
@@ -0,0 +1,151 @@
+#include <catch2/catch.hpp>
+
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <statemachineimage.hpp>
+#include <quotednames.hpp>
+#include <tcpconnection.hpp>
+#include "arduinostubs.hpp"
+
+namespace statemachinegen_test {
+
+// Generated from tests/machines/quoting.json, has no guards or actions
+struct Quoted : QuotedNames<Quoted> {
+};
+
+// Generated from tests/machines/tcp.json by the statemachinegen build step
+struct Connection : TcpConnection<Connection> {
+    std::string m_sent;
+    bool m_passive = false;
+    uint32_t m_failed = 0;
+
+    void listening() {
+        m_passive = true;
+    }
+    void sendSyn() {
+        m_passive = false;
+        m_sent += "S";
+    }
+    void sendSynAck() {
+        m_sent += "s";
+    }
+    void sendAck() {
+        m_sent += "A";
+    }
+    void sendFin() {
+        m_sent += "F";
+    }
+    void connectFailed() {
+        m_failed++;
+    }
+    bool passive() {
+        return m_passive;
+    }
+};
+
+TEST_CASE("Should run a machine generated from a description", "[statemachinegen]") {
+    millisStubbed = 0;
+    Connection connection;
+    connection.start();
+    REQUIRE(connection.current(Connection::CLOSED) == true);
+    REQUIRE(std::string(Connection::name(Connection::SYN_SENT)) == "syn_sent");
+
+    // Active open and close
+    REQUIRE(connection.dispatch(Connection::ACTIVE_OPEN) == true);
+    REQUIRE(connection.dispatch(Connection::ACK) == false);
+    REQUIRE(connection.dispatch(Connection::SYN_ACK) == true);
+    REQUIRE(connection.current(Connection::ESTABLISHED) == true);
+    connection.dispatch(Connection::CLOSE);
+    connection.dispatch(Connection::ACK);
+    connection.dispatch(Connection::FIN);
+    REQUIRE(connection.current(Connection::TIME_WAIT) == true);
+    REQUIRE(connection.m_sent == "SAFA");
+
+    StateTime deadline = 0;
+    REQUIRE(connection.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 240001);
+    millisStubbed = 240001;
+    connection.handle();
+    REQUIRE(connection.current(Connection::CLOSED) == true);
+    REQUIRE(connection.nextDeadline(deadline) == false);
+
+    // The guard decides where a reset goes
+    connection.dispatch(Connection::PASSIVE_OPEN);
+    connection.dispatch(Connection::SYN);
+    connection.dispatch(Connection::RST);
+    REQUIRE(connection.current(Connection::LISTEN) == true);
+    connection.dispatch(Connection::SEND);
+    connection.dispatch(Connection::SYN);
+    connection.dispatch(Connection::RST);
+    REQUIRE(connection.current(Connection::CLOSED) == true);
+
+    // Timeout action
+    connection.dispatch(Connection::ACTIVE_OPEN);
+    REQUIRE(connection.nextDeadline(millisStubbed, deadline) == true);
+    REQUIRE(deadline == millisStubbed + 3001);
+    connection.handle(millisStubbed + 3000);
+    REQUIRE(connection.current(Connection::SYN_SENT) == true);
+    millisStubbed += 3001;
+    connection.handle();
+    REQUIRE(connection.current(Connection::CLOSED) == true);
+    REQUIRE(connection.m_failed == 1);
+}
+
+TEST_CASE("Should behave the same generated and loaded from an image", "[statemachinegen]") {
+    std::ifstream file{TCP_DESCRIPTION};
+    std::stringstream description;
+    description << file.rdbuf();
+    std::vector<uint8_t> image;
+    REQUIRE(StateMachineImage::compile(description.str().c_str(), image) == true);
+
+    bool passive = false;
+    StateMachineCallbacks callbacks;
+    callbacks.guard("passive", [&passive](const StateMachineInstance&) {
+        return passive;
+    });
+
+    for (const char* action : {"listening", "sendSyn", "sendSynAck", "sendAck", "sendFin", "connectFailed"}) {
+        callbacks.action(action, [](const StateMachineInstance&) {
+        });
+    }
+
+    StateMachineImage loaded;
+    REQUIRE(loaded.load(image.data(), image.size(), callbacks) == true);
+    StateMachineInstance instance;
+    loaded.start(instance, 0);
+    Connection generated;
+    generated.start(0);
+
+    std::mt19937 random{7};
+    StateTime time = 0;
+
+    for (int i = 0; i < 10000; i++) {
+        passive = generated.m_passive;
+
+        if (random() % 8 == 0) {
+            time += random() % 250000;
+            loaded.handle(instance, time);
+            generated.handle(time);
+        } else {
+            const EventId event = random() % 10;
+            REQUIRE(loaded.dispatch(instance, event, time) == generated.dispatch(event, time));
+        }
+
+        REQUIRE(instance.state() == generated.state());
+    }
+}
+
+}
+
+TEST_CASE("Should escape state names in generated code", "[statemachinegen]") {
+    using namespace statemachinegen_test;
+    REQUIRE(std::string(Quoted::name(Quoted::SAY__HI_)) == "say \"hi\"");
+    REQUIRE(std::string(Quoted::name(Quoted::BACK_SLASH)) == "back\\slash");
+    REQUIRE(std::string(Quoted::name(Quoted::TAB_HERE)) == "tab\there");
+
+    Quoted machine;
+    machine.start(0);
+    REQUIRE(machine.dispatch(1, 0) == true);
+    REQUIRE(machine.current(Quoted::BACK_SLASH) == true);
+}
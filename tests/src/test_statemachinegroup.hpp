@@ -0,0 +1,151 @@
+#include <catch2/catch.hpp>
+
+#include <statemachinegroup.hpp>
+#include "arduinostubs.hpp"
+
+TEST_CASE("Should handle all machines in a group", "[statemachinegroup]") {
+    millisStubbed = 0;
+    State firstState;
+    StateTimed secondState{10};
+    State thirdState;
+    State otherState;
+
+    firstState.setRunnable([&secondState]() {
+        return &secondState;
+    });
+    secondState.setRunnable([&thirdState]() {
+        return &thirdState;
+    });
+
+    StateMachineGroup group;
+    const size_t first = group.add(&firstState);
+    const size_t other = group.add(&otherState);
+    group.start();
+
+    REQUIRE(group.size() == 2);
+    REQUIRE(group.current(first, &firstState) == true);
+    REQUIRE(group.current(other, &otherState) == true);
+
+    group.handle();
+    REQUIRE(group.current(first, &secondState) == true);
+    REQUIRE(group.current(other, &otherState) == true);
+
+    // Still at second state
+    group.handle();
+    REQUIRE(group.current(first, &secondState) == true);
+
+    // should have been advanced to third state
+    millisStubbed = 11;
+    group.handle();
+    REQUIRE(group.current(first, &thirdState) == true);
+    REQUIRE(group.current(other, &otherState) == true);
+}
+
+TEST_CASE("Should park machines waiting in a timed state", "[statemachinegroup]") {
+    millisStubbed = 100;
+    uint32_t runs = 0;
+    StateTimed waitState{50};
+    State doneState;
+    doneState.setRunnable([&doneState]() {
+        return &doneState;
+    });
+    waitState.setRunnable([&doneState, &runs]() {
+        runs++;
+        return &doneState;
+    });
+
+    StateMachineGroup group;
+    const size_t waiting = group.add(&waitState);
+    const size_t done = group.add(&doneState);
+    group.start();
+
+    group.handle();
+    REQUIRE(group.active() == 1);
+
+    millisStubbed = 150;
+    group.handle();
+    REQUIRE(group.current(waiting, &waitState) == true);
+    REQUIRE(runs == 0);
+
+    millisStubbed = 151;
+    group.handle();
+    REQUIRE(group.current(waiting, &doneState) == true);
+    REQUIRE(group.current(done, &doneState) == true);
+    REQUIRE(group.active() == 2);
+    REQUIRE(runs == 1);
+}
+
+TEST_CASE("Should report when the group needs to be handled next", "[statemachinegroup]") {
+    millisStubbed = 0;
+    StateTimed shortWait{10};
+    StateTimed longWait{20};
+    StateIdle idleState;
+    shortWait.setRunnable([&idleState]() {
+        return &idleState;
+    });
+    longWait.setRunnable([&idleState]() {
+        return &idleState;
+    });
+
+    StateMachineGroup group;
+    group.add(&shortWait);
+    group.add(&longWait);
+    group.start();
+    StateTime deadline = 0;
+
+    REQUIRE(group.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 0);
+
+    group.handle();
+    REQUIRE(group.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 11);
+
+    millisStubbed = 11;
+    group.handle();
+    REQUIRE(group.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 21);
+
+    millisStubbed = 21;
+    group.handle();
+    REQUIRE(group.nextDeadline(deadline) == false);
+}
+
+TEST_CASE("Should wake sleeping and parked machines on events", "[statemachinegroup]") {
+    const EventId GO = 1;
+    millisStubbed = 0;
+    StateEvents<> sleepState;
+    StateEvents<StateTimed> waitState{1000};
+    State doneState;
+    doneState.setRunnable([&doneState]() {
+        return &doneState;
+    });
+    sleepState.on(GO, [&doneState]() {
+        return &doneState;
+    });
+    waitState.on(GO, [&doneState]() {
+        return &doneState;
+    });
+
+    StateMachineGroup group;
+    const size_t sleeping = group.add(&sleepState);
+    const size_t waiting = group.add(&waitState);
+    group.start();
+
+    group.handle();
+    REQUIRE(group.active() == 0);
+    StateTime deadline = 0;
+    REQUIRE(group.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 1001);
+
+    group.dispatch(sleeping, GO);
+    group.dispatch(waiting, GO);
+    REQUIRE(group.current(sleeping, &doneState) == true);
+    REQUIRE(group.current(waiting, &doneState) == true);
+    REQUIRE(group.active() == 2);
+    REQUIRE(group.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 0);
+
+    group.handle();
+    REQUIRE(group.current(waiting, &doneState) == true);
+    REQUIRE(group.active() == 2);
+}
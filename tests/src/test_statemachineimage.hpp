@@ -0,0 +1,178 @@
+#include <catch2/catch.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <statemachineimage.hpp>
+#include "arduinostubs.hpp"
+
+namespace statemachineimage_test {
+
+const EventId CONNECT = 1;
+const EventId CONNECTED = 2;
+const EventId DISCONNECTED = 3;
+
+const char* DESCRIPTION = R"({
+    "initial": "idle",
+    "comment": ["ignored", {"by": "the loader"}, 1.5, true],
+    "states": [
+        {"name": "failed", "on": [{"event": 1, "to": "idle"}]},
+        {"name": "idle", "on": [{"event": 1, "to": "connecting", "action": "connect"}]},
+        {"name": "connecting", "timeout": {"after": 100, "to": "failed", "action": "giveUp"},
+         "on": [{"event": 2, "to": "connected", "guard": "linkUp"}, {"event": 2, "to": "failed"}]},
+        {"name": "connected", "on": [{"event": 3, "to": "idle"}]}
+    ]
+})";
+
+TEST_CASE("Should run a machine compiled from a description", "[statemachineimage]") {
+    millisStubbed = 0;
+    std::vector<uint8_t> image;
+    std::string error;
+    REQUIRE(StateMachineImage::compile(DESCRIPTION, image, &error) == true);
+
+    bool linkUp = false;
+    uint32_t connects = 0;
+    uint32_t giveUps = 0;
+    StateMachineCallbacks callbacks;
+    callbacks.guard("linkUp", [&linkUp](const StateMachineInstance&) {
+        return linkUp;
+    });
+    callbacks.action("connect", [&connects](const StateMachineInstance&) {
+        connects++;
+    });
+    callbacks.action("giveUp", [&giveUps](const StateMachineInstance&) {
+        giveUps++;
+    });
+
+    StateMachineImage machine;
+    REQUIRE(machine.load(image.data(), image.size(), callbacks, &error) == true);
+    REQUIRE(machine.size() == 4);
+    REQUIRE(machine.id("connecting") == 2);
+    REQUIRE(machine.id("unknown") == StateMachineImage::NONE);
+    REQUIRE(std::string(machine.name(3)) == "connected");
+
+    StateMachineInstance instance;
+    machine.start(instance);
+    REQUIRE(instance.state() == machine.id("idle"));
+    REQUIRE(machine.dispatch(instance, DISCONNECTED) == false);
+    REQUIRE(machine.dispatch(instance, CONNECT) == true);
+    REQUIRE(connects == 1);
+
+    // The timeout runs like a StateTimed
+    StateTime deadline = 0;
+    REQUIRE(machine.nextDeadline(instance, deadline) == true);
+    REQUIRE(deadline == 101);
+    millisStubbed = 100;
+    machine.handle(instance);
+    REQUIRE(instance.state() == machine.id("connecting"));
+    millisStubbed = 101;
+    machine.handle(instance);
+    REQUIRE(instance.state() == machine.id("failed"));
+    REQUIRE(giveUps == 1);
+    REQUIRE(machine.nextDeadline(instance, deadline) == false);
+
+    // The first transition whose guard allows it is taken
+    machine.dispatch(instance, CONNECT);
+    machine.dispatch(instance, CONNECT);
+    REQUIRE(machine.dispatch(instance, CONNECTED) == true);
+    REQUIRE(instance.state() == machine.id("failed"));
+
+    linkUp = true;
+    machine.dispatch(instance, CONNECT);
+    machine.dispatch(instance, CONNECT);
+    REQUIRE(machine.dispatch(instance, CONNECTED) == true);
+    REQUIRE(instance.state() == machine.id("connected"));
+}
+
+TEST_CASE("Should report invalid descriptions and images", "[statemachineimage]") {
+    std::vector<uint8_t> image;
+    std::string error;
+
+    REQUIRE(StateMachineImage::compile(R"({"states": [{"name": "a", "on": [{"event": 1, "to": "b"}]}]})", image, &error) == false);
+    REQUIRE(error == "A transition of a goes to unknown state 'b'");
+    REQUIRE(StateMachineImage::compile(R"({"states": [{"name": "a"}, {"name": "a"}]})", image, &error) == false);
+    REQUIRE(error == "State 1 has no name or the name of another state");
+    REQUIRE(StateMachineImage::compile(R"({"states": [{"name": "a", "on": [{"event": 70000, "to": "a"}]}]})", image, &error) == false);
+    REQUIRE(error.find("Number out of range") == 0);
+    REQUIRE(StateMachineImage::compile(R"({"states": [{"name": "a"}])", image, &error) == false);
+    REQUIRE(error == "Expected '}' at offset 26");
+
+    // Unknown keys are skipped up to a limited depth
+    REQUIRE(StateMachineImage::compile((R"({"comment": )" + std::string(1000, '[') + std::string(1000, ']') +
+                                        R"(, "states": [{"name": "a"}]})").c_str(), image, &error) == false);
+    REQUIRE(error.find("Nested too deep") == 0);
+    REQUIRE(StateMachineImage::compile((R"({"comment": )" + std::string(16, '[') + std::string(16, ']') +
+                                        R"(, "states": [{"name": "a"}]})").c_str(), image, &error) == true);
+
+    REQUIRE(StateMachineImage::compile(DESCRIPTION, image, &error) == true);
+    StateMachineCallbacks callbacks;
+    callbacks.action("connect", [](const StateMachineInstance&) {
+    });
+    callbacks.action("giveUp", [](const StateMachineInstance&) {
+    });
+    StateMachineImage machine;
+    REQUIRE(machine.load(image.data(), image.size(), callbacks, &error) == false);
+    REQUIRE(error == "Callback 'linkUp' is not registered");
+
+    // Registered as an action but used as a guard
+    callbacks.action("linkUp", [](const StateMachineInstance&) {
+    });
+    REQUIRE(machine.load(image.data(), image.size(), callbacks, &error) == false);
+    REQUIRE(machine.size() == 0);
+
+    callbacks.guard("linkUp", [](const StateMachineInstance&) {
+        return true;
+    });
+    REQUIRE(machine.load(image.data(), image.size() - 4, callbacks, &error) == false);
+    REQUIRE(error == "Image is damaged");
+    REQUIRE(machine.load(image.data(), image.size(), callbacks) == true);
+}
+
+TEST_CASE("Should reject an image with transitions out of order", "[statemachineimage]") {
+    std::vector<uint8_t> image;
+    REQUIRE(StateMachineImage::compile(R"({"states": [{"name": "a", "on": [{"event": 2, "to": "a"}, {"event": 1, "to": "a"}]}]})", image) == true);
+
+    // Swap the two transitions, each is the event, the target and two unused callbacks
+    const uint8_t first[] = {1, 0, 0, 0, 0xFF, 0xFF, 0xFF, 0xFF, 2, 0, 0, 0, 0xFF, 0xFF, 0xFF, 0xFF};
+    std::vector<uint8_t>::iterator at = std::search(image.begin(), image.end(), first, first + sizeof(first));
+    REQUIRE(at != image.end());
+    std::swap_ranges(at, at + 8, at + 8);
+
+    StateMachineImage machine;
+    std::string error;
+    REQUIRE(machine.load(image.data(), image.size(), StateMachineCallbacks(), &error) == false);
+    REQUIRE(error == "Transitions of a state are not sorted by event");
+}
+
+TEST_CASE("Should run a memory mapped image in place", "[statemachineimage]") {
+    std::vector<uint8_t> image;
+    REQUIRE(StateMachineImage::compile(R"({"states": [{"name": "off", "on": [{"event": 1, "to": "on"}]},
+        {"name": "on", "on": [{"event": 1, "to": "off"}]}]})", image) == true);
+
+    char path[] = "/tmp/statemachineimageXXXXXX";
+    const int fd = mkstemp(path);
+    REQUIRE(fd >= 0);
+    REQUIRE(write(fd, image.data(), image.size()) == (ssize_t)image.size());
+    void* mapped = mmap(nullptr, image.size(), PROT_READ, MAP_PRIVATE, fd, 0);
+    REQUIRE(mapped != MAP_FAILED);
+
+    StateMachineImage machine;
+    REQUIRE(machine.load(mapped, image.size(), StateMachineCallbacks()) == true);
+    std::vector<StateMachineInstance> instances(1000);
+
+    for (StateMachineInstance& instance : instances) {
+        machine.start(instance, 0);
+    }
+
+    machine.dispatch(instances[10], 1, 0);
+    REQUIRE(instances[10].state() == 1);
+    REQUIRE(instances[11].state() == 0);
+
+    munmap(mapped, image.size());
+    close(fd);
+    unlink(path);
+}
+
+}
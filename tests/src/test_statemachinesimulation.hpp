@@ -0,0 +1,131 @@
+#include <catch2/catch.hpp>
+
+#include <memory>
+#include <vector>
+#include <statemachinesimulation.hpp>
+#include "arduinostubs.hpp"
+
+namespace statemachinesimulation_test {
+
+// Counts how often its wait expired
+struct Blinker {
+    uint32_t m_blinks = 0;
+    StateTimed m_state;
+
+    Blinker(const StateTime p_period) : m_state(p_period) {
+        m_state.setRunnable([this]() {
+            m_blinks++;
+            return &m_state;
+        });
+    }
+};
+
+}
+
+TEST_CASE("Should jump to the next expiry in a simulation", "[statemachinesimulation]") {
+    using namespace statemachinesimulation_test;
+    const StateTime WEEK = 7UL * 24 * 3600 * 1000;
+    std::vector<std::unique_ptr<Blinker>> blinkers;
+    StateMachineGroup group;
+
+    for (StateTime i = 0; i < 1000; i++) {
+        blinkers.emplace_back(new Blinker(60000 + i * 1000));
+        group.add(&blinkers.back()->m_state);
+    }
+
+    StateMachineSimulation simulation{group};
+    simulation.start();
+    simulation.runFor(WEEK);
+
+    REQUIRE(simulation.time() == WEEK);
+
+    uint64_t blinks = 0;
+
+    for (StateTime i = 0; i < blinkers.size(); i++) {
+        // The wait of a StateTimed expires the tick after its time
+        REQUIRE(blinkers[i]->m_blinks == WEEK / (60000 + i * 1000 + 1));
+        blinks += blinkers[i]->m_blinks;
+    }
+
+    // Only handled when something expired instead of every millisecond
+    REQUIRE(simulation.steps() <= blinks + 1);
+}
+
+TEST_CASE("Should dispatch scheduled events in a simulation", "[statemachinesimulation]") {
+    std::vector<EventId> received;
+    StateEvents<> waiting;
+    StateIdle done;
+    waiting.on(1, [&received, &waiting]() {
+        received.push_back(1);
+        return &waiting;
+    });
+    waiting.on(2, [&received, &done]() {
+        received.push_back(2);
+        return &done;
+    });
+
+    StateMachineGroup group;
+    const size_t machine = group.add(&waiting);
+    StateMachineSimulation simulation{group, 1000};
+    simulation.start();
+    simulation.schedule(5000, machine, 2);
+    simulation.schedule(5000, machine, 1);
+    simulation.schedule(3000, machine, 1);
+
+    simulation.runUntil(4999);
+    REQUIRE(received == std::vector<EventId> {1});
+    REQUIRE(group.current(machine, &waiting) == true);
+
+    // Same time in the order they were scheduled
+    simulation.runUntil(5000);
+    REQUIRE(received == std::vector<EventId> {1, 2});
+    REQUIRE(group.current(machine, &done) == true);
+    REQUIRE(simulation.steps() == 3);
+}
+
+TEST_CASE("Should move polling machines one tick at a time in a simulation", "[statemachinesimulation]") {
+    uint32_t runs = 0;
+    State polling;
+    polling.setRunnable([&polling, &runs]() {
+        runs++;
+        return &polling;
+    });
+
+    StateMachineGroup group;
+    group.add(&polling);
+    StateMachineSimulation simulation{group};
+    simulation.start();
+    simulation.runFor(10);
+    REQUIRE(runs == 11);
+    REQUIRE(simulation.steps() == 11);
+}
+
+TEST_CASE("Should not jump past a shorter wait that starts after a long one", "[statemachinesimulation]") {
+    // The long wait is further away than the group's timer wheel covers, 2^24 ms
+    std::vector<StateTime> expired;
+    StateIdle done;
+    StateTimed longWait{36000000};
+    StateTimed first{15000000};
+    StateTimed second{5000000};
+
+    StateMachineGroup group;
+    StateMachineSimulation simulation{group};
+    longWait.setRunnable([&expired, &simulation, &done]() {
+        expired.push_back(simulation.time());
+        return &done;
+    });
+    first.setRunnable([&expired, &simulation, &second]() {
+        expired.push_back(simulation.time());
+        return &second;
+    });
+    second.setRunnable([&expired, &simulation, &done]() {
+        expired.push_back(simulation.time());
+        return &done;
+    });
+    group.add(&longWait);
+    group.add(&first);
+
+    simulation.start();
+    simulation.runFor(40000000);
+    REQUIRE(expired == std::vector<StateTime> {15000001, 20000002, 36000001});
+}
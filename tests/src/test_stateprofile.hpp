@@ -0,0 +1,66 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <statemachine.hpp>
+#include <stateprofile.hpp>
+#include "arduinostubs.hpp"
+
+TEST_CASE("Should count entries, dwell and run time per state", "[stateprofile]") {
+    millisStubbed = 0;
+    microsStubbed = 0;
+    State firstState;
+    StateTimed secondState{10};
+    firstState.setName("first");
+    secondState.setName("second");
+
+    // Each run of the first state takes 5us
+    firstState.setRunnable([&secondState]() {
+        microsStubbed += 5;
+        return &secondState;
+    });
+    secondState.setRunnable([&firstState]() {
+        return &firstState;
+    });
+
+    StateMachine machine {&firstState};
+    machine.start();
+    REQUIRE(firstState.profile().m_entries == 1);
+
+    // first -> second at 0, second -> first at 11, first -> second at 20
+    machine.handle();
+    millisStubbed = 11;
+    machine.handle();
+    millisStubbed = 20;
+    machine.handle();
+    millisStubbed = 25;
+    machine.handle();
+
+    const StateProfile& first = firstState.profile();
+    const StateProfile& second = secondState.profile();
+    REQUIRE(first.m_entries == 2);
+    REQUIRE(first.m_runs == 2);
+    REQUIRE(first.m_runTime == 10);
+    REQUIRE(first.m_dwellTime == 9);
+    REQUIRE(first.m_maxDwellTime == 9);
+    REQUIRE(second.m_entries == 2);
+    REQUIRE(second.m_runs == 2);
+    REQUIRE(second.m_dwellTime == 11);
+    REQUIRE(second.m_maxDwellTime == 11);
+
+    const std::string json = profileJson({&firstState, &secondState});
+    REQUIRE(json == "[{\"name\":\"first\",\"entries\":2,\"dwellTime\":9,\"maxDwellTime\":9,\"runs\":2,\"runTime\":10},"
+            "{\"name\":\"second\",\"entries\":2,\"dwellTime\":11,\"maxDwellTime\":11,\"runs\":2,\"runTime\":0}]");
+
+    const std::string table = profileTable({&firstState, &secondState});
+    REQUIRE(table.find("first") != std::string::npos);
+    REQUIRE(std::count(table.begin(), table.end(), '\n') == 3);
+
+    firstState.resetProfile();
+    REQUIRE(firstState.profile().m_entries == 0);
+}
+
+TEST_CASE("Should escape state names in the profile JSON", "[stateprofile]") {
+    State state;
+    state.setName("say \"hi\"\\\n\t");
+    REQUIRE(profileJson({&state}).find("{\"name\":\"say \\\"hi\\\"\\\\\\u000a\\u0009\",") == 1);
+}
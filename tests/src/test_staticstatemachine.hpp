@@ -0,0 +1,144 @@
+#include <catch2/catch.hpp>
+
+#include <staticstatemachine.hpp>
+#include <statemachine.hpp>
+#include "arduinostubs.hpp"
+
+namespace staticstatemachine_test {
+
+struct FirstState;
+struct SecondState;
+struct ThirdState;
+typedef StaticStates<FirstState, SecondState, ThirdState> Chain;
+
+struct FirstState {
+    StaticStateId run(const uint32_t currentMillis) {
+        return Chain::id<SecondState>();
+    }
+};
+
+struct SecondState {
+    StaticStateId run(const uint32_t currentMillis) {
+        return Chain::id<ThirdState>();
+    }
+};
+
+struct ThirdState {
+    int m_runs = 0;
+    StaticStateId run(const uint32_t currentMillis) {
+        m_runs++;
+        return Chain::id<ThirdState>();
+    }
+};
+
+struct Waiting;
+struct Running;
+typedef StaticStates<Waiting, Running> Timed;
+
+struct Waiting : StaticStateTimed<Waiting, Timed> {
+    Waiting() : StaticStateTimed(10) {
+    }
+
+    StaticStateId expired(const StateTime currentMillis) {
+        return Timed::id<Running>();
+    }
+};
+
+struct Running {
+    uint32_t m_starts = 0;
+    uint32_t m_ends = 0;
+    uint32_t m_runs = 0;
+
+    void transitionStart(const StateTime currentMillis) {
+        m_starts++;
+    }
+
+    void transitionEnd(const StateTime currentMillis) {
+        m_ends++;
+    }
+
+    StaticStateId run(const StateTime currentMillis) {
+        return ++m_runs % 3 == 0 ? Timed::id<Waiting>() : Timed::id<Running>();
+    }
+};
+
+static_assert(statemachine_detail::HasTransitionStart<Running>::value, "Running has transitionStart");
+static_assert(!statemachine_detail::HasTransitionStart<FirstState>::value, "FirstState has no transitionStart");
+static_assert(!statemachine_detail::AnyTransitionEnd<FirstState, SecondState, ThirdState>::value, "Chain has no hooks");
+
+}
+
+TEST_CASE("Should correctly get current value with static state machine", "[staticstatemachine]") {
+    using namespace staticstatemachine_test;
+    StaticStateMachine<Chain> machine;
+    machine.start();
+
+    REQUIRE(Chain::id<FirstState>() == 0);
+    REQUIRE(Chain::id<ThirdState>() == 2);
+
+    // Should initially be at the first state
+    REQUIRE(machine.current<FirstState>() == true);
+
+    // then second state
+    machine.handle();
+    REQUIRE(machine.current<SecondState>() == true);
+
+    // then third state
+    machine.handle();
+    REQUIRE(machine.current(Chain::id<ThirdState>()) == true);
+
+    // well advance and should always end in last state
+    machine.handle();
+    machine.handle();
+    REQUIRE(machine.current<ThirdState>() == true);
+    REQUIRE(machine.current<SecondState>() == false);
+    REQUIRE(machine.state<ThirdState>().m_runs == 2);
+}
+
+TEST_CASE("Should call transition hooks of static states", "[staticstatemachine]") {
+    using namespace staticstatemachine_test;
+    StaticStateMachine<Timed> machine;
+    machine.start(0);
+
+    machine.handle(11);
+    REQUIRE(machine.current<Running>() == true);
+    REQUIRE(machine.state<Running>().m_starts == 1);
+
+    // Self loops are no transitions
+    machine.handle(12);
+    REQUIRE(machine.state<Running>().m_starts == 1);
+    REQUIRE(machine.state<Running>().m_ends == 0);
+
+    machine.handle(13);
+    machine.handle(14);
+    REQUIRE(machine.current<Waiting>() == true);
+    REQUIRE(machine.state<Running>().m_ends == 1);
+}
+
+TEST_CASE("Should time a StaticStateTimed like a StateTimed", "[staticstatemachine]") {
+    using namespace staticstatemachine_test;
+    StaticStateMachine<Timed> machine;
+    uint32_t runs = 0;
+    StateTimed waiting{10};
+    State running;
+    waiting.setRunnable([&running]() {
+        return &running;
+    });
+    running.setRunnable([&running, &waiting, &runs]() -> State* {
+        if (++runs % 3 == 0) {
+            return &waiting;
+        }
+
+        return &running;
+    });
+    StateMachine reference{&waiting};
+
+    machine.start(5);
+    reference.start(5);
+
+    for (StateTime time = 5; time < 200; time += 3) {
+        machine.handle(time);
+        reference.handle(time);
+        REQUIRE(machine.current<Waiting>() == reference.current(&waiting));
+    }
+}
@@ -0,0 +1,63 @@
+#include <catch2/catch.hpp>
+
+#include <statictransitiontable.hpp>
+
+namespace statictransitiontable_test {
+
+enum : StaticStateId { IDLE, RUNNING, PAUSED, BROKEN, STATES };
+enum : EventId { START, STOP, PAUSE, FAULT };
+
+typedef StaticTransitionTable<STATES, IDLE,
+        StaticOn<IDLE, START, RUNNING>,
+        StaticOn<RUNNING, STOP, IDLE>,
+        StaticOn<RUNNING, PAUSE, PAUSED>,
+        StaticOn<PAUSED, START, RUNNING>,
+        StaticOn<PAUSED, STOP, IDLE>,
+        StaticOn<RUNNING, FAULT, BROKEN>,
+        StaticFinal<BROKEN>> Motor;
+
+static_assert(Motor::events == 4, "Events are counted from the transitions");
+static_assert(Motor::next(IDLE, START) == RUNNING, "Transitions are known at compile time");
+static_assert(Motor::next(IDLE, STOP) == IDLE, "States stay in place on events they don't react to");
+
+// PAUSED can't be reached and BROKEN has no way out
+typedef StaticTransitionTable<STATES, IDLE,
+        StaticOn<IDLE, START, RUNNING>,
+        StaticOn<RUNNING, STOP, IDLE>,
+        StaticOn<PAUSED, START, RUNNING>,
+        StaticOn<RUNNING, FAULT, BROKEN>> Broken;
+
+static_assert(Broken::validStates(), "All states exist");
+static_assert(Broken::unique(), "No duplicate transitions");
+static_assert(!Broken::reachable(PAUSED) && Broken::reachable(BROKEN), "PAUSED is unreachable");
+static_assert(!Broken::allReachable(), "Unreachable states are found");
+static_assert(!Broken::hasExit(BROKEN) && Broken::hasExit(PAUSED), "BROKEN is a sink");
+static_assert(!Broken::allExit(), "Sinks are found");
+
+typedef StaticTransitionTable<2, 0, StaticOn<0, START, 2>, StaticOn<0, START, 1>, StaticOn<1, STOP, 0>> Dangling;
+
+static_assert(!Dangling::validStates(), "Targets that don't exist are found");
+static_assert(!Dangling::unique(), "Two transitions for one event are found");
+
+TEST_CASE("Should dispatch events through a static transition table", "[statictransitiontable]") {
+    StaticTransitionMachine<Motor> motor;
+    REQUIRE(motor.current(IDLE) == true);
+
+    REQUIRE(motor.dispatch(STOP) == false);
+    REQUIRE(motor.dispatch(START) == true);
+    REQUIRE(motor.current(RUNNING) == true);
+    REQUIRE(motor.dispatch(PAUSE) == true);
+    REQUIRE(motor.state() == PAUSED);
+    REQUIRE(motor.dispatch(START) == true);
+
+    // Events outside of the table are ignored
+    REQUIRE(motor.dispatch(42) == false);
+    REQUIRE(motor.dispatch(FAULT) == true);
+    REQUIRE(motor.current(BROKEN) == true);
+    REQUIRE(motor.dispatch(START) == false);
+
+    motor.start();
+    REQUIRE(motor.current(IDLE) == true);
+}
+
+}
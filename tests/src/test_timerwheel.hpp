@@ -0,0 +1,145 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <timerwheel.hpp>
+
+TEST_CASE("Should expire timer wheel entries at their deadline", "[timerwheel]") {
+    TimerWheel wheel{1000};
+    std::vector<uint32_t> expired;
+
+    wheel.schedule(0, 1010);
+    wheel.schedule(1, 1000 + 5000);
+    wheel.schedule(2, 1000 + 300000);
+    wheel.schedule(3, 1000 + 50000000);
+    wheel.schedule(4, 1020);
+    wheel.cancel(4);
+    REQUIRE(wheel.size() == 4);
+
+    wheel.advance(1009, expired);
+    REQUIRE(expired.empty());
+    wheel.advance(1010, expired);
+    REQUIRE(expired == std::vector<uint32_t> {0});
+
+    expired.clear();
+    wheel.advance(5999, expired);
+    REQUIRE(expired.empty());
+    wheel.advance(6000, expired);
+    REQUIRE(expired == std::vector<uint32_t> {1});
+
+    expired.clear();
+    wheel.advance(301000, expired);
+    REQUIRE(expired == std::vector<uint32_t> {2});
+
+    expired.clear();
+    wheel.advance(50000999, expired);
+    REQUIRE(expired.empty());
+    wheel.advance(50001000, expired);
+    REQUIRE(expired == std::vector<uint32_t> {3});
+    REQUIRE(wheel.size() == 0);
+}
+
+TEST_CASE("Should expire timer wheel entries like a sorted list", "[timerwheel]") {
+    // Start close to the uint32_t wrap around
+    const uint32_t start = 0xFFFF0000;
+    TimerWheel wheel{start};
+    std::vector<uint32_t> deadlines;
+    uint32_t random = 12345;
+
+    for (uint32_t i = 0; i < 2000; i++) {
+        random = random * 1103515245 + 12345;
+        const uint32_t deadline = start + 1 + (random >> 8) % (i % 2 ? 5000 : 40000000);
+        deadlines.push_back(deadline);
+        wheel.schedule(i, deadline);
+    }
+
+    uint32_t time = start;
+    std::vector<uint32_t> expired;
+
+    for (int step = 0; step < 400; step++) {
+        random = random * 1103515245 + 12345;
+        time += (random >> 8) % 60000;
+        expired.clear();
+        wheel.advance(time, expired);
+
+        for (const uint32_t entry : expired) {
+            // Only once and never early
+            REQUIRE(deadlines[entry] != start);
+            REQUIRE(deadlines[entry] - start <= time - start);
+            deadlines[entry] = start;
+
+            // Some come back later, often nearer than parked entries
+            if (entry % 3 == 0) {
+                random = random * 1103515245 + 12345;
+                deadlines[entry] = time + 1 + (random >> 8) % (entry % 2 ? 5000 : 6000000);
+                wheel.schedule(entry, deadlines[entry]);
+            }
+        }
+
+        uint32_t earliest = 0;
+        bool pending = false;
+
+        for (uint32_t i = 0; i < deadlines.size(); i++) {
+            // Never late
+            REQUIRE((deadlines[i] == start || deadlines[i] - start > time - start));
+
+            if (deadlines[i] != start && (!pending || deadlines[i] - start < earliest - start)) {
+                earliest = deadlines[i];
+                pending = true;
+            }
+        }
+
+        // Also with parked entries in slots before nearer ones
+        uint32_t deadline = 0;
+        REQUIRE(wheel.nextDeadline(deadline) == pending);
+
+        if (pending) {
+            REQUIRE(deadline == earliest);
+        }
+    }
+}
+
+TEST_CASE("Should report the next deadline of a timer wheel", "[timerwheel]") {
+    TimerWheel wheel{1000};
+    std::vector<uint32_t> expired;
+    uint32_t deadline = 0;
+
+    REQUIRE(wheel.nextDeadline(deadline) == false);
+
+    wheel.schedule(0, 1000 + 70000);
+    wheel.schedule(1, 1000 + 5000);
+    REQUIRE(wheel.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 6000);
+
+    wheel.schedule(2, 1010);
+    REQUIRE(wheel.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 1010);
+
+    wheel.advance(1010, expired);
+    REQUIRE(wheel.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 6000);
+
+    wheel.advance(6000, expired);
+    REQUIRE(wheel.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 71000);
+}
+
+TEST_CASE("Should report the next deadline of a timer wheel past parked entries", "[timerwheel]") {
+    TimerWheel wheel{1};
+    std::vector<uint32_t> expired;
+    uint32_t deadline = 0;
+
+    // Further away than the wheel covers, parked in the last slot of the top level
+    wheel.schedule(0, 36000001);
+    wheel.advance(15000001, expired);
+    REQUIRE(expired.empty());
+
+    // Its slot comes before the slot of this nearer entry
+    wheel.schedule(1, 20000002);
+    REQUIRE(wheel.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 20000002);
+
+    wheel.advance(20000002, expired);
+    REQUIRE(expired == std::vector<uint32_t> {1});
+    REQUIRE(wheel.nextDeadline(deadline) == true);
+    REQUIRE(deadline == 36000001);
+}
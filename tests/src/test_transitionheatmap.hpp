@@ -0,0 +1,117 @@
+#include <catch2/catch.hpp>
+
+#include <thread>
+#include <vector>
+#include <statemachine.hpp>
+#include <transitionheatmap.hpp>
+#include "arduinostubs.hpp"
+
+namespace transitionheatmap_test {
+
+#if STATEMACHINE_HEATMAP
+TEST_CASE("Should count transitions and dwell time per edge", "[transitionheatmap]") {
+    millisStubbed = 0;
+    uint32_t ticks = 0;
+    StateTimed waiting{10};
+    State working;
+    StateEvents<StateIdle> stopped;
+    waiting.setName("waiting");
+    working.setName("working");
+    waiting.setRunnable([&working]() {
+        return &working;
+    });
+    working.setRunnable([&waiting, &working, &ticks]() {
+        return ++ticks % 3 == 0 ? &waiting : &working;
+    });
+    stopped.on(1, [&waiting]() {
+        return &waiting;
+    });
+
+    TransitionHeatMap heatMap;
+    StateMachine machine{&waiting};
+    machine.setHeatMap(&heatMap);
+    machine.start();
+
+    for (uint32_t i = 1; i <= 96; i++) {
+        millisStubbed = i;
+        machine.handle();
+    }
+
+    const std::vector<TransitionHeatMap::Edge> edges = heatMap.edges();
+    REQUIRE(edges.size() == 2);
+    // Each round waits 11 ms and works 3 ms
+    REQUIRE(edges[0].m_from == &waiting);
+    REQUIRE(edges[0].m_to == &working);
+    REQUIRE(edges[0].m_count == 7);
+    REQUIRE(edges[0].m_dwellTime == 7 * 11);
+    REQUIRE(edges[1].m_from == &working);
+    REQUIRE(edges[1].m_count == 6);
+    REQUIRE(edges[1].m_dwellTime == 6 * 3);
+    REQUIRE(heatMap.dropped() == 0);
+
+    const std::string dot = heatMapDot(heatMap, {&waiting, &working, &stopped});
+    REQUIRE(dot.find("digraph heatmap {\n") == 0);
+    REQUIRE(dot.find("  \"state2\";\n") != std::string::npos);
+    REQUIRE(dot.find("  \"waiting\" -> \"working\" [label=\"7\\navg 11.0\", penwidth=8.00, color=\"0.000 1.000 0.900\"];\n") != std::string::npos);
+    REQUIRE(dot.find("  \"working\" -> \"waiting\" [label=\"6\\navg 3.0\", penwidth=7.00, color=\"0.095") != std::string::npos);
+
+    heatMap.clear();
+    REQUIRE(heatMap.edges().empty() == true);
+}
+
+TEST_CASE("Should escape state names in the DOT output", "[transitionheatmap]") {
+    State state;
+    state.setName("say \"hi\"\\\n\t");
+    TransitionHeatMap heatMap;
+    REQUIRE(heatMapDot(heatMap, {&state}).find("  \"say \\\"hi\\\"\\\\\\u000a\\u0009\";\n") != std::string::npos);
+}
+#endif
+
+TEST_CASE("Should merge the counts of all threads", "[transitionheatmap][threads]") {
+    State states[4];
+    // Fewer shards than threads so threads share shards as well
+    TransitionHeatMap heatMap{8, 3};
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < 6; t++) {
+        threads.emplace_back([&heatMap, &states]() {
+            for (uint32_t i = 0; i < 10000; i++) {
+                heatMap.record(&states[i % 4], &states[(i + 1) % 4], 2);
+            }
+        });
+    }
+
+    // Reading while counting is allowed
+    uint64_t seen = 0;
+
+    for (const TransitionHeatMap::Edge& edge : heatMap.edges()) {
+        seen += edge.m_count;
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    const std::vector<TransitionHeatMap::Edge> edges = heatMap.edges();
+    REQUIRE(edges.size() == 4);
+
+    for (const TransitionHeatMap::Edge& edge : edges) {
+        REQUIRE(edge.m_count == 6 * 2500);
+        REQUIRE(edge.m_dwellTime == 6 * 2500 * 2);
+    }
+
+    REQUIRE(seen <= 60000);
+}
+
+TEST_CASE("Should drop edges that don't fit", "[transitionheatmap]") {
+    State states[3];
+    TransitionHeatMap heatMap{2, 1};
+    heatMap.record(&states[0], &states[1], 0);
+    heatMap.record(&states[1], &states[2], 0);
+    heatMap.record(&states[2], &states[0], 0);
+    heatMap.record(&states[0], &states[1], 0);
+    REQUIRE(heatMap.edges().size() == 2);
+    REQUIRE(heatMap.dropped() == 1);
+}
+
+}
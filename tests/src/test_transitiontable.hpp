@@ -0,0 +1,129 @@
+#include <catch2/catch.hpp>
+
+#include <statemachine.hpp>
+#include <transitiontable.hpp>
+#include "arduinostubs.hpp"
+
+namespace transitiontable_test {
+
+const EventId START = 0;
+const EventId STOP = 1;
+const EventId FAULT = 5;
+
+void checkTurnstile(const TransitionTable::Format p_format) {
+    millisStubbed = 0;
+    StateIdle idle;
+    StateIdle running;
+    StateEvents<> failed;
+    StateIdle reset;
+    uint32_t stops = 0;
+    TransitionTable table;
+
+    REQUIRE(table.on(&idle, START, &running) == true);
+    REQUIRE(table.on(&running, STOP, &idle, [&stops]() {
+        stops++;
+    }) == true);
+    REQUIRE(table.on(&running, FAULT, &failed) == true);
+    // One transition per state and event
+    REQUIRE(table.on(&running, STOP, &failed) == false);
+    table.build(p_format);
+    REQUIRE(table.format() == p_format);
+    REQUIRE(table.states() == 3);
+    REQUIRE(table.size() == 3);
+    REQUIRE(idle.id() == 0);
+    REQUIRE(running.id() == 1);
+    REQUIRE(failed.id() == 2);
+    REQUIRE(reset.id() == State::NO_ID);
+
+    // States that are not in the table fall back to react()
+    failed.on(START, [&reset]() {
+        return &reset;
+    });
+
+    StateMachine machine{&idle};
+    machine.setTransitionTable(&table);
+    machine.start();
+
+    machine.dispatch(STOP);
+    REQUIRE(machine.current(&idle) == true);
+    machine.dispatch(START);
+    REQUIRE(machine.current(&running) == true);
+    machine.dispatch(STOP);
+    REQUIRE(machine.current(&idle) == true);
+    REQUIRE(stops == 1);
+
+    machine.dispatch(START);
+    // Unknown events are ignored
+    machine.dispatch(42);
+    REQUIRE(machine.current(&running) == true);
+    machine.dispatch(FAULT);
+    REQUIRE(machine.current(&failed) == true);
+    machine.dispatch(START);
+    REQUIRE(machine.current(&reset) == true);
+}
+
+TEST_CASE("Should transition through a dense table", "[transitiontable]") {
+    checkTurnstile(TransitionTable::FORMAT_DENSE);
+}
+
+TEST_CASE("Should transition through a sparse table", "[transitiontable]") {
+    checkTurnstile(TransitionTable::FORMAT_SPARSE);
+}
+
+TEST_CASE("Should pick the table format by density", "[transitiontable]") {
+    std::vector<StateIdle> states(100);
+    TransitionTable table;
+
+    // Few transitions per state over many events
+    for (size_t i = 0; i < states.size(); i++) {
+        table.on(&states[i], i, &states[(i + 1) % states.size()]);
+    }
+
+    table.build();
+    REQUIRE(table.format() == TransitionTable::FORMAT_SPARSE);
+    REQUIRE(table.find(&states[3], 3)->m_to == &states[4]);
+    REQUIRE(table.find(&states[3], 4) == nullptr);
+
+    // A state can only be in one table
+    TransitionTable other;
+    REQUIRE(other.add(&states[0]) == State::NO_ID);
+
+    std::vector<StateIdle> few(4);
+    TransitionTable small;
+
+    for (size_t i = 0; i < few.size(); i++) {
+        small.on(&few[i], START, &few[(i + 1) % few.size()]);
+    }
+
+    small.build();
+    REQUIRE(small.format() == TransitionTable::FORMAT_DENSE);
+}
+
+TEST_CASE("Should only find transitions of states in the table", "[transitiontable]") {
+    StateIdle idle;
+    StateIdle running;
+    StateIdle other;
+    StateIdle otherNext;
+
+    {
+        TransitionTable first;
+        REQUIRE(first.on(&idle, START, &running) == true);
+        first.build();
+    }
+
+    // The destroyed table released its states
+    REQUIRE(idle.id() == State::NO_ID);
+    TransitionTable table;
+    REQUIRE(table.on(&idle, START, &running) == true);
+    table.build();
+
+    // Has the same id as idle in another table
+    TransitionTable otherTable;
+    REQUIRE(otherTable.on(&other, STOP, &otherNext) == true);
+    otherTable.build();
+    REQUIRE(other.id() == idle.id());
+    REQUIRE(table.find(&other, START) == nullptr);
+    REQUIRE(table.find(&idle, START)->m_to == &running);
+}
+
+}
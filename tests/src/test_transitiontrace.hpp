@@ -0,0 +1,48 @@
+#include <catch2/catch.hpp>
+
+#include <statemachine.hpp>
+#include <transitiontrace.hpp>
+#include "arduinostubs.hpp"
+
+TEST_CASE("Should record transitions in a ring buffer", "[transitiontrace]") {
+    millisStubbed = 0;
+    State firstState;
+    State secondState;
+    firstState.setRunnable([&secondState]() {
+        return &secondState;
+    });
+    secondState.setRunnable([&firstState]() {
+        return &firstState;
+    });
+    firstState.setName("first");
+
+    TransitionTrace trace{4};
+    StateMachine machine {&firstState};
+    machine.setTrace(&trace);
+    machine.start();
+
+    REQUIRE(trace.size() == 0);
+
+    for (uint32_t i = 1; i <= 6; i++) {
+        millisStubbed = i;
+        machine.handle();
+    }
+
+    // Only the last 4 transitions are kept
+    REQUIRE(trace.capacity() == 4);
+    REQUIRE(trace.size() == 4);
+    REQUIRE(trace.total() == 6);
+    REQUIRE(trace[0].m_time == 3);
+    REQUIRE(trace[0].m_from == &firstState);
+    REQUIRE(trace[0].m_to == &secondState);
+    REQUIRE(trace[3].m_time == 6);
+    REQUIRE(trace[3].m_from == &secondState);
+    REQUIRE(std::string(trace[3].m_to->name()) == "first");
+
+    // Staying in a state is not a transition
+    machine.setTrace(nullptr);
+    machine.handle();
+    REQUIRE(trace.total() == 6);
+    trace.clear();
+    REQUIRE(trace.size() == 0);
+}
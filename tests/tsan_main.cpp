@@ -0,0 +1,10 @@
+// Tests that use threads, build with ThreadSanitizer
+
+// Let Catch provide main():
+#define CATCH_CONFIG_MAIN
+
+#include "catch2/catch.hpp"
+#include "src/test_eventqueue.hpp"
+#include "src/test_statemachineexecutor.hpp"
+#include "src/test_statemachinedefinition.hpp"
+#include "src/test_transitionheatmap.hpp"
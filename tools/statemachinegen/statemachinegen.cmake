@@ -0,0 +1,27 @@
+# Builds the statemachinegen code generator and adds statemachine_generate() to run it as a build step:
+#
+# include(../tools/statemachinegen/statemachinegen.cmake)
+# statemachine_generate(${CMAKE_CURRENT_SOURCE_DIR}/session.json ${CMAKE_CURRENT_BINARY_DIR}/generated/session.hpp Session)
+# add_executable(app main.cpp ${CMAKE_CURRENT_BINARY_DIR}/generated/session.hpp)
+
+set(STATEMACHINEGEN_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+if (NOT TARGET statemachinegen)
+    add_executable(statemachinegen
+        ${STATEMACHINEGEN_DIR}/statemachinegen.cpp
+        ${STATEMACHINEGEN_DIR}/../../src/statemachinedescription.cpp)
+    target_include_directories(statemachinegen PRIVATE ${STATEMACHINEGEN_DIR}/../../src)
+    # Runs on the host, not on Arduino
+    target_compile_definitions(statemachinegen PRIVATE UNIT_TEST)
+endif()
+
+# Generates OUTPUT with class template CLASS from the machine description DESCRIPTION
+function(statemachine_generate DESCRIPTION OUTPUT CLASS)
+    get_filename_component(OUTPUT_DIR ${OUTPUT} DIRECTORY)
+    add_custom_command(
+        OUTPUT ${OUTPUT}
+        COMMAND ${CMAKE_COMMAND} -E make_directory ${OUTPUT_DIR}
+        COMMAND statemachinegen ${DESCRIPTION} ${OUTPUT} ${CLASS}
+        DEPENDS statemachinegen ${DESCRIPTION}
+        COMMENT "Generating ${CLASS} from ${DESCRIPTION}")
+endfunction()
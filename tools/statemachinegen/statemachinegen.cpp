@@ -0,0 +1,424 @@
+/**
+ * Generates a C++ header from a machine description, see StateMachineDescription for the format.
+ * The generated class template dispatches events with a switch on the state and the event,
+ * keeps timeouts and names in constexpr tables and stores the state in the smallest enum that fits.
+ * Guards and actions are member functions of the class that derives from it, so they can be inlined.
+ *
+ * Usage: statemachinegen <description.json> <output.hpp> <ClassName>
+ * Use statemachine_generate() from statemachinegen.cmake to run it as a build step.
+ */
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include <statemachinedescription.hpp>
+
+namespace {
+
+// Upper case identifier for a state or event name
+std::string identifier(const std::string& p_name) {
+    std::string result;
+
+    for (const char c : p_name) {
+        const bool alphanumeric = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+        result += alphanumeric ? (c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c) : '_';
+    }
+
+    return result.empty() || (result[0] >= '0' && result[0] <= '9') ? "S_" + result : result;
+}
+
+// C++ string literal of p_text, quotes, backslashes and control characters escaped
+std::string literal(const std::string& p_text) {
+    std::string result = "\"";
+
+    for (const char c : p_text) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if (static_cast<unsigned char>(c) < 0x20 || c == 0x7F) {
+            // Always three octal digits so a following digit is not taken as part of the escape
+            char escape[5];
+            snprintf(escape, sizeof(escape), "\\%03o", static_cast<unsigned char>(c));
+            result += escape;
+        } else {
+            result += c;
+        }
+    }
+
+    return result + "\"";
+}
+
+// True when p_name can be used as the name of a member function
+bool validIdentifier(const std::string& p_name) {
+    static const char* const KEYWORDS[] = {
+        "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch",
+        "char", "char8_t", "char16_t", "char32_t", "class", "compl", "concept", "const", "consteval", "constexpr",
+        "constinit", "const_cast", "continue", "co_await", "co_return", "co_yield", "decltype", "default", "delete",
+        "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "float", "for",
+        "friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+        "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register", "reinterpret_cast",
+        "requires", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct",
+        "switch", "template", "this", "thread_local", "throw", "true", "try", "typedef", "typeid", "typename",
+        "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq"
+    };
+
+    if (p_name.empty() || (p_name[0] >= '0' && p_name[0] <= '9')) {
+        return false;
+    }
+
+    for (const char c : p_name) {
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_')) {
+            return false;
+        }
+    }
+
+    for (const char* keyword : KEYWORDS) {
+        if (p_name == keyword) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Case label for p_event, its name when it has one
+std::string eventLabel(const StateMachineDescription& p_description, const EventId p_event) {
+    for (const StateMachineDescription::Event& event : p_description.events()) {
+        if (event.m_id == p_event) {
+            return identifier(event.m_name);
+        }
+    }
+
+    return std::to_string(p_event);
+}
+
+bool readFile(const char* p_path, std::string& p_text) {
+    FILE* file = fopen(p_path, "rb");
+
+    if (file == nullptr) {
+        return false;
+    }
+
+    char buffer[4096];
+    size_t read;
+
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        p_text.append(buffer, read);
+    }
+
+    fclose(file);
+    return true;
+}
+
+// Declaration of the guards and actions the derived class implements, for the doc comment
+std::string callbackDocs(const StateMachineDescription& p_description) {
+    std::string docs;
+
+    for (const std::string& callback : p_description.callbacks()) {
+        bool guard = false;
+
+        for (const StateMachineDescription::State& state : p_description.states()) {
+            for (const StateMachineDescription::Transition& transition : state.m_transitions) {
+                guard = guard || transition.m_guard == callback;
+            }
+        }
+
+        docs += std::string(" *     ") + (guard ? "bool " : "void ") + callback + "();\n";
+    }
+
+    return docs;
+}
+
+std::string generate(const StateMachineDescription& p_description, const std::string& p_source, const std::string& p_class) {
+    const std::vector<StateMachineDescription::State>& states = p_description.states();
+    const std::string stateType = states.size() < 255 ? "uint8_t" : "uint16_t";
+    const std::string none = std::to_string(states.size());
+    std::string out;
+
+    out += "#pragma once\n";
+    out += "// Generated by statemachinegen from " + p_source + ", do not edit\n";
+    out += "#include <stdint.h>\n";
+    out += "#include <statemachine.hpp>\n";
+    out += "#include <statetiming.hpp>\n\n";
+    out += "/**\n";
+    out += " * Machine from " + p_source + ". Derive from " + p_class + "<Derived> and implement the guards and actions:\n";
+    out += callbackDocs(p_description);
+    out += " * Has the start(), handle(), current() and dispatch() of a StateMachine without any virtual call.\n";
+    out += " */\n";
+    out += "template<typename Derived>\n";
+    out += "class " + p_class + " {\n";
+    out += "public:\n";
+    out += "    enum StateId : " + stateType + " {\n";
+
+    for (const StateMachineDescription::State& state : states) {
+        out += "        " + identifier(state.m_name) + ",\n";
+    }
+
+    out += "        STATES\n";
+    out += "    };\n";
+
+    if (!p_description.events().empty()) {
+        out += "\n    enum Event : EventId {\n";
+
+        for (const StateMachineDescription::Event& event : p_description.events()) {
+            out += "        " + identifier(event.m_name) + " = " + std::to_string(event.m_id) + ",\n";
+        }
+
+        out += "    };\n";
+    }
+
+    out += "\nprivate:\n";
+    out += "    // Time after which a state takes its timeout and the state it goes to, STATES when it has none\n";
+    out += "    static constexpr StateTiming s_timings[STATES] = {";
+
+    for (size_t i = 0; i < states.size(); i++) {
+        out += (i == 0 ? "" : ", ");
+        out += states[i].m_timeoutTo == StateMachineDescription::NONE ? "{0, StateTiming::KIND_IDLE}" : "{" + std::to_string(states[i].m_timeout) + ", StateTiming::KIND_TIMED}";
+    }
+
+    out += "};\n";
+    out += "    static constexpr " + stateType + " s_timeoutTo[STATES] = {";
+
+    for (size_t i = 0; i < states.size(); i++) {
+        out += (i == 0 ? "" : ", ") + (states[i].m_timeoutTo == StateMachineDescription::NONE ? none : std::to_string(states[i].m_timeoutTo));
+    }
+
+    out += "};\n";
+    out += "    static constexpr const char* s_names[STATES] = {";
+
+    for (size_t i = 0; i < states.size(); i++) {
+        out += (i == 0 ? "" : ", ") + literal(states[i].m_name);
+    }
+
+    out += "};\n\n";
+    out += "    StateId m_currentState;\n";
+    out += "    StateTime m_startTime;\n\n";
+    out += "    Derived& derived() {\n";
+    out += "        return *static_cast<Derived*>(this);\n";
+    out += "    }\n\n";
+    out += "    void enter(const StateId p_state, const StateTime p_currentTime) {\n";
+    out += "        m_currentState = p_state;\n";
+    out += "        m_startTime = p_currentTime;\n";
+    out += "    }\n\n";
+    out += "public:\n";
+    out += "    " + p_class + "() :\n";
+    out += "        m_currentState(" + identifier(states[p_description.initial()].m_name) + "),\n";
+    out += "        m_startTime(0) {\n";
+    out += "    }\n\n";
+    out += "    static const char* name(const StateId p_state) {\n";
+    out += "        return s_names[p_state];\n";
+    out += "    }\n\n";
+    out += "    StateId state() const {\n";
+    out += "        return m_currentState;\n";
+    out += "    }\n\n";
+    out += "    // Evaluates if the current state is the given state\n";
+    out += "    bool current(const StateId p_state) const {\n";
+    out += "        return m_currentState == p_state;\n";
+    out += "    }\n\n";
+    out += "    // Call start once after you created the state machine\n";
+    out += "    void start() {\n";
+    out += "        start(MillisClock::now());\n";
+    out += "    }\n\n";
+    out += "    void start(const StateTime p_currentTime) {\n";
+    out += "        enter(" + identifier(states[p_description.initial()].m_name) + ", p_currentTime);\n";
+    out += "    }\n\n";
+    out += "    // Takes the timeout of the current state once it has passed\n";
+    out += "    void handle() {\n";
+    out += "        handle(MillisClock::now());\n";
+    out += "    }\n\n";
+    out += "    void handle(const StateTime p_currentTime) {\n";
+    out += "        const StateTiming& timing = s_timings[m_currentState];\n\n";
+    out += "        if (timing.m_kind == StateTiming::KIND_IDLE || !timing.due(m_startTime, p_currentTime)) {\n";
+    out += "            return;\n";
+    out += "        }\n\n";
+
+    bool timeoutActions = false;
+
+    for (const StateMachineDescription::State& state : states) {
+        timeoutActions = timeoutActions || !state.m_timeoutAction.empty();
+    }
+
+    if (timeoutActions) {
+        out += "        switch (m_currentState) {\n";
+
+        for (const StateMachineDescription::State& state : states) {
+            if (!state.m_timeoutAction.empty()) {
+                out += "            case " + identifier(state.m_name) + ":\n";
+                out += "                derived()." + state.m_timeoutAction + "();\n";
+                out += "                break;\n\n";
+            }
+        }
+
+        out += "            default:\n";
+        out += "                break;\n";
+        out += "        }\n\n";
+    }
+
+    out += "        enter(static_cast<StateId>(s_timeoutTo[m_currentState]), p_currentTime);\n";
+    out += "    }\n\n";
+    out += "    // Takes the first transition on p_event whose guard allows it, returns false when there is none\n";
+    out += "    bool dispatch(const EventId p_event) {\n";
+    out += "        return dispatch(p_event, MillisClock::now());\n";
+    out += "    }\n\n";
+    out += "    bool dispatch(const EventId p_event, const StateTime p_currentTime) {\n";
+    out += "        switch (m_currentState) {\n";
+
+    for (const StateMachineDescription::State& state : states) {
+        if (state.m_transitions.empty()) {
+            continue;
+        }
+
+        out += "            case " + identifier(state.m_name) + ":\n";
+        out += "                switch (p_event) {\n";
+        std::vector<EventId> done;
+
+        for (const StateMachineDescription::Transition& first : state.m_transitions) {
+            bool seen = false;
+
+            for (const EventId event : done) {
+                seen = seen || event == first.m_event;
+            }
+
+            if (seen) {
+                continue;
+            }
+
+            done.push_back(first.m_event);
+            out += "                    case " + eventLabel(p_description, first.m_event) + ":\n";
+            bool unconditional = false;
+
+            // Transitions on the same event in the order of the description, up to the first without guard
+            for (const StateMachineDescription::Transition& transition : state.m_transitions) {
+                if (transition.m_event != first.m_event || unconditional) {
+                    continue;
+                }
+
+                std::string indent = "                        ";
+
+                if (!transition.m_guard.empty()) {
+                    out += indent + "if (derived()." + transition.m_guard + "()) {\n";
+                    indent += "    ";
+                } else {
+                    unconditional = true;
+                }
+
+                if (!transition.m_action.empty()) {
+                    out += indent + "derived()." + transition.m_action + "();\n";
+                }
+
+                out += indent + "enter(" + identifier(states[transition.m_to].m_name) + ", p_currentTime);\n";
+                out += indent + "return true;\n";
+
+                if (!transition.m_guard.empty()) {
+                    out += "                        }\n\n";
+                }
+            }
+
+            if (!unconditional) {
+                out += "                        break;\n";
+            }
+
+            out += "\n";
+        }
+
+        out += "                    default:\n";
+        out += "                        break;\n";
+        out += "                }\n\n";
+        out += "                break;\n\n";
+    }
+
+    out += "            default:\n";
+    out += "                break;\n";
+    out += "        }\n\n";
+    out += "        return false;\n";
+    out += "    }\n\n";
+    out += "    // Sets p_deadline to when the timeout of the current state passes, returns false when it has none\n";
+    out += "    bool nextDeadline(StateTime& p_deadline) const {\n";
+    out += "        return nextDeadline(MillisClock::now(), p_deadline);\n";
+    out += "    }\n\n";
+    out += "    bool nextDeadline(const StateTime p_currentTime, StateTime& p_deadline) const {\n";
+    out += "        return s_timings[m_currentState].deadline(m_startTime, p_currentTime, false, p_deadline);\n";
+    out += "    }\n";
+    out += "};\n\n";
+    out += "template<typename Derived>\n";
+    out += "constexpr StateTiming " + p_class + "<Derived>::s_timings[STATES];\n\n";
+    out += "template<typename Derived>\n";
+    out += "constexpr " + stateType + " " + p_class + "<Derived>::s_timeoutTo[STATES];\n\n";
+    out += "template<typename Derived>\n";
+    out += "constexpr const char* " + p_class + "<Derived>::s_names[STATES];\n";
+    return out;
+}
+
+// Returns an error when a guard or action is not a C++ identifier or two states or events get the same identifier
+std::string checkIdentifiers(const StateMachineDescription& p_description) {
+    for (const std::string& callback : p_description.callbacks()) {
+        if (!validIdentifier(callback)) {
+            return "Guard or action '" + callback + "' is not a C++ identifier";
+        }
+    }
+
+    std::vector<std::string> used{"STATES"};
+
+    for (const StateMachineDescription::State& state : p_description.states()) {
+        used.push_back(identifier(state.m_name));
+    }
+
+    for (const StateMachineDescription::Event& event : p_description.events()) {
+        used.push_back(identifier(event.m_name));
+    }
+
+    for (size_t i = 0; i < used.size(); i++) {
+        for (size_t j = 0; j < i; j++) {
+            if (used[i] == used[j]) {
+                return "Two states or events are both named " + used[i];
+            }
+        }
+    }
+
+    return "";
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc != 4) {
+        fprintf(stderr, "Usage: %s <description.json> <output.hpp> <ClassName>\n", argv[0]);
+        return 2;
+    }
+
+    std::string text;
+
+    if (!readFile(argv[1], text)) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    StateMachineDescription description;
+    std::string error;
+
+    if (!description.parse(text.c_str(), &error) || !(error = checkIdentifiers(description)).empty()) {
+        fprintf(stderr, "%s: %s\n", argv[1], error.c_str());
+        return 1;
+    }
+
+    std::string source = argv[1];
+    source = source.substr(source.find_last_of('/') + 1);
+    const std::string header = generate(description, source, argv[3]);
+
+    // Leave an unchanged header alone so it does not trigger a rebuild
+    std::string previous;
+
+    if (readFile(argv[2], previous) && previous == header) {
+        return 0;
+    }
+
+    FILE* out = fopen(argv[2], "wb");
+
+    if (out == nullptr || fwrite(header.data(), 1, header.size(), out) != header.size()) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    fclose(out);
+    return 0;
+}